@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <vector>
+
+#include "../lexer.h"
+#include "../../common/gen.h"
+
+using namespace std;
+
+//How each token type is written; NULL where the generator makes the lexeme
+const char* spelling[] = { NULL,
+    "IF", "WHILE", "DO", "THEN", "PRINT",
+    "+", "-", "/", "*",
+    "=", ":", ",", ";",
+    "[", "]", "(", ")",
+    "<>", ">", "<", "<=", ">=",
+    ".", NULL, NULL, "@", NULL, NULL, NULL
+};
+static_assert(sizeof(spelling) / sizeof(spelling[0]) == BASE16NUM + 1, "one spelling per token type in lexer.h");
+
+unsigned long long seed = 1;
+long long outputSize = 1 << 20; //Bytes to write
+int reuse = 80;     //Percent of IDs already used
+int numbers = 25;   //Percent of tokens that are number literals
+int real = 10;      //Percent of number literals of each class, the rest NUM
+int base08 = 10;
+int base16 = 10;
+int backtrack = 0;  //Percent of number literals ScanNumber lexes as a NUM after putting characters back
+int errors = 0;     //Percent of tokens that are ERROR
+
+//Sets the knobs of a preset
+bool preset(const char* name)
+{
+    if (strcmp(name, "backtrack") == 0) //Long digit & hex runs whose base suffix fails, so ScanNumber puts them back
+    {
+        numbers = 80;
+        backtrack = 90;
+        return true;
+    }
+    return strcmp(name, "default") == 0;
+}
+
+//Writes count random characters from digits
+void put_digits(genOutput& out, genRandom& random, const char* digits, int count)
+{
+    int n = strlen(digits);
+    for (int i = 0; i < count; i++)
+        out.Put(digits + random.Below(n), 1);
+}
+
+//Writes a number literal of a class picked by the knobs
+void put_number(genOutput& out, genRandom& random)
+{
+    int roll = random.Below(100);
+    if ((roll -= backtrack) < 0) //A hex run whose suffix is no base, so all but the leading digits go back
+    {
+        out.Put("123456789" + random.Below(9), 1);
+        put_digits(out, random, "0123456789ABCDEF", 4 + random.Below(20));
+        static const char* endings[] = { "x", "x0", "x1", "x01", "x17" };
+        out.Put(endings[random.Below(5)]);
+    }
+    else if ((roll -= real) < 0)
+    {
+        out.Number(random.Below(100000));
+        out.Put(".");
+        put_digits(out, random, "0123456789", 1 + random.Below(6));
+    }
+    else if ((roll -= base08) < 0)
+    {
+        out.Put("1234567" + random.Below(7), 1);
+        put_digits(out, random, "01234567", random.Below(8));
+        out.Put("x08");
+    }
+    else if ((roll -= base16) < 0)
+    {
+        out.Put("123456789" + random.Below(9), 1);
+        put_digits(out, random, "0123456789ABCDEF", random.Below(8));
+        out.Put("x16");
+    }
+    else
+        out.Number(random.Below(1000000));
+}
+
+//Writes lines of tokens split by spaces until size bytes are out
+int main(int argc, char* argv[])
+{
+    vector<genKnob> knobs = {
+        { "reuse", &reuse, "percent of IDs already used" },
+        { "numbers", &numbers, "percent of tokens that are number literals" },
+        { "real", &real, "percent of number literals that are REALNUM" },
+        { "base08", &base08, "percent of number literals that are BASE08NUM" },
+        { "base16", &base16, "percent of number literals that are BASE16NUM" },
+        { "backtrack", &backtrack, "percent of number literals that backtrack to a NUM" },
+        { "errors", &errors, "percent of tokens that are ERROR" },
+    };
+    if (!read_knobs(argc, argv, seed, outputSize, knobs, "default|backtrack", preset))
+        return 1;
+
+    genRandom random(seed);
+    genOutput out;
+    long long ids = 0;
+    while (out.written < outputSize)
+    {
+        int count = 4 + random.Below(12);
+        for (int i = 0; i < count; i++)
+        {
+            if (i > 0)
+                out.Put(" ");
+            if (random.Percent(numbers))
+                put_number(out, random);
+            else if (random.Percent(errors))
+                out.Put(spelling[ERROR]);
+            else if (random.Percent(40)) //ID
+                out.Name("v", (ids > 0 && random.Percent(reuse)) ? random.Below(ids) : ids++);
+            else //Keyword or punctuation
+            {
+                int type;
+                do
+                    type = 1 + random.Below(BASE16NUM);
+                while (spelling[type] == NULL || type == ERROR);
+                out.Put(spelling[type]);
+            }
+        }
+        out.Put("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../lexer.h"
+#include "../../common/harness.h"
+
+using namespace std;
+
+#define BENCH_TEXT (1 << 18) //Bytes of input per run
+
+//Reaches the scanners GetToken calls, so each is timed on its own
+struct benchAccess
+{
+    typedef LexicalAnalyzer<StringSource> stringLexer;
+    static bool SkipSpace(stringLexer& lexer) { return lexer.SkipSpace(); }
+    static Token ScanIdOrKeyword(stringLexer& lexer) { return lexer.ScanIdOrKeyword(); }
+    static Token ScanNumber(stringLexer& lexer) { return lexer.ScanNumber(); }
+    static void GetChar(stringLexer& lexer, char& c) { lexer.input.GetChar(c); }
+};
+
+string texts[10];
+LexicalAnalyzer<StringSource>* lexer = NULL;
+
+//Starts a new lexer on a text
+void lex_text(const string& text)
+{
+    delete lexer;
+    lexer = new LexicalAnalyzer<StringSource>(StringSource(text), 1);
+}
+
+//Lexes a whole program with GetToken from the source made before each run, one token per op
+template <class Source>
+benchCase token_case(const string& name, long long tokens, const string& text, function<Source()> source)
+{
+    static LexicalAnalyzer<Source>* sourceLexer = NULL;
+    return { name, tokens, (long long) text.size(),
+             [source] {
+                 delete sourceLexer;
+                 sourceLexer = new LexicalAnalyzer<Source>(source(), 1);
+             },
+             [] {
+                 while (sourceLexer->GetToken().token_type != END_OF_FILE)
+                     ;
+             } };
+}
+
+//Scans the words of text, each followed by one space
+benchCase scan_case(const string& name, string& text, const string& words, bool number)
+{
+    string piece = words + " ";
+    text = repeat_text(piece, BENCH_TEXT);
+    long long scans = text.size() / piece.size() * count(piece.begin(), piece.end(), ' ');
+    return { name, scans, (long long) text.size(),
+             [&text] { lex_text(text); },
+             [scans, number] {
+                 for (long long i = 0; i < scans; i++)
+                 {
+                     if (number)
+                         benchAccess::ScanNumber(*lexer);
+                     else
+                         benchAccess::ScanIdOrKeyword(*lexer);
+                     benchAccess::SkipSpace(*lexer);
+                 }
+             } };
+}
+
+//Driver Code
+int main(int argc, char* argv[])
+{
+    vector<benchCase> cases;
+    InputBuffer<StringSource> input;
+
+    texts[0] = repeat_text("x1 = y2 + 345;\n", BENCH_TEXT);
+    cases.push_back({ "InputBuffer::GetChar", (long long) texts[0].size(), (long long) texts[0].size(),
+                      [&input] { input = InputBuffer<StringSource>(StringSource(texts[0])); },
+                      [&input] {
+                          char c;
+                          for (size_t i = 0; i < texts[0].size(); i++)
+                              input.GetChar(c);
+                      } });
+
+    texts[1] = repeat_text("  \t\n    x", BENCH_TEXT);
+    long long runs = texts[1].size() / 9;
+    cases.push_back({ "SkipSpace", runs, (long long) texts[1].size(),
+                      [] { lex_text(texts[1]); },
+                      [runs] {
+                          char c;
+                          for (long long i = 0; i < runs; i++)
+                          {
+                              benchAccess::SkipSpace(*lexer);
+                              benchAccess::GetChar(*lexer, c); //The x ending each run of spaces
+                          }
+                      } });
+
+    cases.push_back(scan_case("ScanIdOrKeyword", texts[2], "counter1 WHILE x THEN y2z", false));
+    cases.push_back(scan_case("ScanNumber/NUM", texts[3], "9876543", true));
+    cases.push_back(scan_case("ScanNumber/REALNUM", texts[4], "314.159", true));
+    cases.push_back(scan_case("ScanNumber/BASE08NUM", texts[5], "1234567x08", true));
+    cases.push_back(scan_case("ScanNumber/BASE16NUM", texts[6], "9ABCDEFx16", true));
+
+    //1234 is a NUM once x1 fails as a base, putting back ABx1, which is then an ID
+    texts[7] = repeat_text("1234ABx1 ", BENCH_TEXT);
+    long long backtracks = texts[7].size() / 9;
+    cases.push_back({ "ScanNumber/backtrack", backtracks, (long long) texts[7].size(),
+                      [] { lex_text(texts[7]); },
+                      [backtracks] {
+                          for (long long i = 0; i < backtracks; i++)
+                          {
+                              benchAccess::ScanNumber(*lexer);
+                              benchAccess::ScanIdOrKeyword(*lexer);
+                              benchAccess::SkipSpace(*lexer);
+                          }
+                      } });
+
+    //The same program read through each input source; the mapped & block sources read a copy in a temporary file
+    texts[8] = repeat_text("WHILE x1 <> 0 DO y2 = (y2 + 345) * 3.14;\nIF z <= 1234567x08 THEN PRINT A1Fx16 . ab;\n", BENCH_TEXT);
+    long long tokens = 0;
+    lex_text(texts[8]);
+    while (lexer->GetToken().token_type != END_OF_FILE)
+        tokens++;
+    char path[] = "/tmp/cse340_microXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, texts[8].data(), texts[8].size()) != (ssize_t) texts[8].size())
+    {
+        cerr << "Cannot write " << path << endl;
+        return 1;
+    }
+    MappedSource mapped(path);
+    unlink(path);
+    istringstream streamText;
+
+    cases.push_back(token_case<StreamSource>("GetToken/stream", tokens, texts[8], [&streamText] {
+        streamText.str(texts[8]);
+        cin.rdbuf(streamText.rdbuf());
+        cin.clear();
+        return StreamSource();
+    }));
+    cases.push_back(token_case<StringSource>("GetToken/string", tokens, texts[8], [] { return StringSource(texts[8]); }));
+    cases.push_back(token_case<MappedSource>("GetToken/mapped", tokens, texts[8], [&mapped] { return mapped; }));
+    cases.push_back(token_case<BlockSource>("GetToken/block", tokens, texts[8], [fd] {
+        lseek(fd, 0, SEEK_SET);
+        return BlockSource(fd);
+    }));
+
+    //The program with IDs past ASCII, each letter of them 2 or 3 bytes of UTF-8
+    texts[9] = repeat_text("WHILE größe <> 0 DO naïve = (naïve + 345) * 3.14;\nIF 名前 <= 1234567x08 THEN PRINT Δx . ab;\n", BENCH_TEXT);
+    long long utf8Tokens = 0;
+    lex_text(texts[9]);
+    while (lexer->GetToken().token_type != END_OF_FILE)
+        utf8Tokens++;
+    cases.push_back(token_case<StringSource>("GetToken/utf8", utf8Tokens, texts[9], [] { return StringSource(texts[9]); }));
+
+    //Checking the UTF-8 of each program on its own, one byte per op
+    for (int t = 8; t <= 9; t++)
+    {
+        cases.push_back({ (t == 8) ? "utf8Check/ascii" : "utf8Check/utf8", (long long) texts[t].size(), (long long) texts[t].size(),
+                          [] {},
+                          [t] {
+                              utf8Check check;
+                              check.Add(texts[t].data(), texts[t].size(), 0);
+                              if (check.Error() >= 0)
+                                  abort();
+                          } });
+    }
+
+    return run_benchmarks("Project1", cases, argc, argv);
+}
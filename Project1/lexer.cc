@@ -3,9 +3,17 @@
 #include <vector>
 #include <string>
 #include <cctype>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "lexer.h"
-#include "inputbuf.h"
+#include "../common/stats.h"
 
 using namespace std;
 
@@ -19,9 +27,6 @@ string reserved[] =
     "DOT", "NUM", "ID", "ERROR", "REALNUM", "BASE08NUM", "BASE16NUM"
 };
 
-#define KEYWORDS_COUNT 5
-string keyword[] = { "IF", "WHILE", "DO", "THEN", "PRINT" };
-
 void Token::Print() //Formatted Print
 {
     cout << "{" << this->lexeme << " , "
@@ -29,415 +34,261 @@ void Token::Print() //Formatted Print
          << this->line_no << "}\n";
 }
 
-LexicalAnalyzer::LexicalAnalyzer() //Constructor
+//The lexer for each input source
+template class LexerCore<projectTokens, StreamSource>;
+template class LexerCore<projectTokens, StringSource>;
+template class LexerCore<projectTokens, MappedSource>;
+template class LexerCore<projectTokens, BlockSource>;
+
+StreamToken TokenStream::Next(LexicalAnalyzer<StringSource>& lexer, int reach) //Lexes one token & where it lies
 {
-    this->line_no = 1;
-    tmp.lexeme = "";
-    tmp.line_no = 1;
-    tmp.token_type = ERROR;
+    StreamToken next;
+    next.token = lexer.GetToken();
+    next.offset = lexer.TokenOffset();
+    next.end = lexer.Offset();
+    next.reach = max(reach, lexer.Reach());
+    return next;
 }
 
-bool LexicalAnalyzer::SkipSpace() //Assists with skipping spaces
+void TokenStream::Lex(const string& s) //Lexes a whole text
 {
-    char c;
-    bool space_encountered = false;
+    text = s;
+    tokens.clear();
+    LexicalAnalyzer<StringSource> lexer(StringSource(text), 1);
+    int reach = -1;
+    do
+    {
+        tokens.push_back(Next(lexer, reach));
+        reach = tokens.back().reach;
+    } while (tokens.back().token.token_type != END_OF_FILE);
+}
 
-    input.GetChar(c);
-    line_no += (c == '\n');
+int TokenStream::Edit(int start, int length, const string& replacement) //Replaces text[start, start + length)
+{
+    int delta = replacement.size() - length;
+    int lines = count(replacement.begin(), replacement.end(), '\n') - count(text.begin() + start, text.begin() + start + length, '\n');
+    text.replace(start, length, replacement);
 
-    while (!input.EndOfInput() && isspace(c)) 
-	{
-        space_encountered = true;
-        input.GetChar(c);
-        line_no += (c == '\n');
+    //Tokens that never looked at the edited bytes are kept; a number can look 3 bytes past its end
+    int first = 0, high = tokens.size() - 1;
+    while (first < high)
+    {
+        int middle = (first + high) / 2;
+        if (tokens[middle].reach < start)
+            first = middle + 1;
+        else
+            high = middle;
     }
 
-    if (!input.EndOfInput()) 
-	{
-        input.UngetChar(c);
-    }
-    return space_encountered;
-}
+    //Lexing between tokens only depends on the offset & line, so restart where the kept tokens end
+    int offset = (first > 0) ? tokens[first - 1].end : 0;
+    int line = (first > 0) ? tokens[first - 1].token.line_no : 1;
+    int reach = (first > 0) ? tokens[first - 1].reach : -1;
+    LexicalAnalyzer<StringSource> lexer(StringSource(text, offset), line);
 
-bool LexicalAnalyzer::IsKeyword(string s)
-{
-    for (int i = 0; i < KEYWORDS_COUNT; i++) 
-	{
-        if (s == keyword[i]) 
-		{
-            return true;
+    vector<StreamToken> fresh;
+    int old = first;
+    while (true)
+    {
+        StreamToken next = Next(lexer, reach);
+
+        //An old token after the edit, at the same place with the same text, means the rest is unchanged
+        while (old < (int) tokens.size() && (tokens[old].offset < start + length || tokens[old].offset + delta < next.offset))
+            old++;
+        if (old < (int) tokens.size())
+        {
+            StreamToken& match = tokens[old];
+            if (match.offset + delta == next.offset && match.end + delta == next.end &&
+                match.token.token_type == next.token.token_type && match.token.lexeme == next.token.lexeme &&
+                match.token.line_no + lines == next.token.line_no)
+                break;
         }
-    }
-    return false;
-}
 
-TokenType LexicalAnalyzer::FindKeywordIndex(string s)
-{
-    for (int i = 0; i < KEYWORDS_COUNT; i++) 
-	{
-        if (s == keyword[i]) 
-		{
-            return (TokenType) (i + 1);
+        fresh.push_back(next);
+        reach = next.reach;
+        if (next.token.token_type == END_OF_FILE)
+        {
+            old = tokens.size();
+            break;
         }
     }
-    return ERROR;
-}
 
-bool ispdigit(char c) //Assists with NUM
-{
-    return c >= '1' && c <= '9';
+    //Tokens after the edit only move; moving them is the one step linear in the text
+    for (int i = old; i < (int) tokens.size() && (delta != 0 || lines != 0 || tokens[i].reach < reach); i++)
+    {
+        tokens[i].offset += delta;
+        tokens[i].end += delta;
+        tokens[i].reach = max(tokens[i].reach + delta, reach);
+        tokens[i].token.line_no += lines;
+        reach = tokens[i].reach;
+    }
+    int removed = old - first;
+    int added = fresh.size();
+    if (added > removed) //Open a gap, moving the tokens after once
+        tokens.insert(tokens.begin() + old, added - removed, StreamToken());
+    else if (added < removed)
+        tokens.erase(tokens.begin() + first + added, tokens.begin() + old);
+    for (int i = 0; i < added; i++)
+        tokens[first + i] = fresh[i];
+    return added;
 }
 
-bool ispdigit8(char c) //Assists with Base08NUM
+const string& TokenStream::Text()
 {
-    return c >= '1' && c <= '7';
+    return text;
 }
 
-bool isdigit8(char c) //Assists with Base08NUM
+//Reads the program from standard input & an edit script, printing the tokens after each edit.
+//Each edit is a line "offset length", a line with a byte count, then that many bytes & a newline.
+void run_edits(const char* path)
 {
-    return c == '0' || ispdigit8(c);
-}
+    string text((istreambuf_iterator<char>(cin)), istreambuf_iterator<char>());
+    ifstream edits(path, ios::binary);
+    if (!edits)
+    {
+        cerr << "Cannot open " << path << endl;
+        exit(1);
+    }
 
-bool ispdigit16(char c) //Assists with Base16NUM
-{
-    return (c >= '1' && c <= '9') || (c >= 'A' && c <= 'F');
-}
+    TokenStream stream;
+    stream.Lex(text);
+    long long relexed = 0;
+    double editMs = 0;
+    int edit = 0;
+    string line;
+    while (true)
+    {
+        cout << "=== edit " << edit << "\n";
+        for (size_t i = 0; i < stream.tokens.size(); i++)
+            stream.tokens[i].token.Print();
 
-bool isdigit16(char c) //Assists with Base16NUM
-{
-    return c == '0' || ispdigit16(c);
+        int start, length, bytes;
+        if (!getline(edits, line) || sscanf(line.c_str(), "%d %d", &start, &length) != 2)
+            break;
+        if (!getline(edits, line) || sscanf(line.c_str(), "%d", &bytes) != 1)
+            break;
+        string replacement(bytes, '\0');
+        edits.read(&replacement[0], bytes);
+        getline(edits, line);
+        if (start < 0 || length < 0 || start + length > (int) stream.Text().size())
+        {
+            cerr << "Edit " << edit + 1 << " is outside the text" << endl;
+            exit(1);
+        }
+        chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+        relexed += stream.Edit(start, length, replacement);
+        editMs += chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        edit++;
+    }
+    cerr << "edits: " << edit << ", tokens lexed again: " << relexed << ", tokens now: " << stream.tokens.size()
+         << ", editing: " << editMs << " ms" << endl;
 }
 
-Token LexicalAnalyzer::ScanNumber() //Checks for type of number
+void lex_files(const vector<const char*>& files, TokenFormat format) //Lexes files on threads, writing their tokens in order
 {
-    char c, b, a;
-    bool base8 = true;
-    bool base10 = true;
-    input.GetChar(c);
-    input.GetChar(b);
-    
-    if (isdigit(c)) 
-    {
-        if (c == '0' && b != 'x' && b != '.') //Base check for NUM
+    vector<MappedSource> sources(files.size());
+    { //Mapping the files is the input phase
+        phaseTimer reading(PHASE_INPUT);
+        for (size_t f = 0; f < files.size(); f++)
         {
-            input.UngetChar(b);
-            tmp.lexeme = "0";
-            tmp.token_type = NUM;
-            tmp.line_no = line_no;
-        }
-        else // TODO: Check for REALNUM, BASE08NUM and BASE16NUM here!
-        {
-            input.UngetChar(b);
-            tmp.lexeme = "";
-            while (!input.EndOfInput() && isdigit8(c)) //Checks for digit
-            {
-                tmp.lexeme += c;
-                input.GetChar(c);
-            }
-            while (!input.EndOfInput() && isdigit(c)) //Checks for base8 conditions
-            {
-                base8 = false;
-                tmp.lexeme += c;
-                input.GetChar(c);
-            }
-            while (!input.EndOfInput() && isxdigit(c) && (isdigit(c) || isupper(c))) //Checks for base16 conditions
-            {
-                base8 = false;
-                base10 = false;
-                tmp.lexeme += c;
-                input.GetChar(c);
-            }
-			
-			if (c == 'x' && base8) //Check for BASE8NUM & Edge conditions
-            {
-                input.GetChar(b);
-                input.GetChar(a);
-                if (b == '0' && a == '8') //BASE08NUM Conditions
-                {
-                    tmp.lexeme = tmp.lexeme + c + b + a;
-                    tmp.token_type = BASE08NUM;
-                }
-                else if (b == '1' && a == '6') //Edge case for BASE16NUM
-                {
-                    tmp.lexeme = tmp.lexeme + c + b + a;
-                    tmp.token_type = BASE16NUM;
-                } 
-                else //Return NUM and backtrack
-                {
-                    input.UngetChar(a);
-                    input.UngetChar(b);
-                    input.UngetChar(c);
-                    int front = 0;
-                    while(front < tmp.lexeme.length() && isdigit(tmp.lexeme[front]))
-                    {
-                        front++;
-                    }
-                    for (int back = tmp.lexeme.length() - 1; back >= front; back--)
-                    {
-                        input.UngetChar(tmp.lexeme[back]);
-                        tmp.lexeme.erase(back);
-                    }
-                    tmp.token_type = NUM;
-                    tmp.line_no = line_no;
-                }
-            }
-			else if (c == 'x' && !base8) //Handle Base16NUMs
-            {
-                input.GetChar(b);
-                input.GetChar(a);
-                if (b == '1' && a == '6') //Check for BASE16NUM
-                {
-                    tmp.lexeme = tmp.lexeme + c + b + a;
-                    tmp.token_type = BASE16NUM;
-                    tmp.line_no = line_no;
-                } 
-                else //Return NUM and backtrack
-                {
-                    input.UngetChar(a);
-                    input.UngetChar(b);
-                    input.UngetChar(c);
-                    int front = 0;
-                    while(front < tmp.lexeme.length() && isdigit(tmp.lexeme[front]))
-                    {
-                        front++;
-                    }
-                    for (int back = tmp.lexeme.length() - 1; back >= front; back--)
-                    {
-                        input.UngetChar(tmp.lexeme[back]);
-                        tmp.lexeme.erase(back);
-                    }
-                    tmp.token_type = NUM;
-                    tmp.line_no = line_no;
-                }
-            }
-            else if (c == '.' && base10) //Check for REALNUM
-            {
-                input.GetChar(b);
-                if (!isdigit(b)) //Check for NUM
-                {
-                    input.UngetChar(b);
-                    input.UngetChar(c);
-                    tmp.token_type = NUM;
-                    tmp.line_no = line_no;
-                    return tmp;
-				}
-				
-                tmp.lexeme = tmp.lexeme + c + b;
-                input.GetChar(c);
-				
-                while (isdigit(c) && !input.EndOfInput()) //Collect the REALNUM
-                {
-                    tmp.lexeme += c;
-                    input.GetChar(c);
-                }
-                if (!input.EndOfInput()) //Backtrack end of file
-                {
-                    input.UngetChar(c);
-                }
-                tmp.token_type = REALNUM;
-                tmp.line_no = line_no;
-            }
-			else if (c != '.' && base10) //Check for NUM
+            sources[f] = MappedSource(files[f]);
+            if (!sources[f].opened)
             {
-                input.UngetChar(c);
-                tmp.token_type = NUM;
-                tmp.line_no = line_no;
+                cerr << "Cannot open " << files[f] << endl;
+                exit(1);
             }
-            else //Return NUM and backtrack
-            {
-                input.UngetChar(c);
-                int front = 0;
-                while(front < tmp.lexeme.length() && isdigit(tmp.lexeme[front]))
-                {
-                    front++;
-                }
-                for (int back = tmp.lexeme.length() - 1; back >= front; back--)
-                {
-                    input.UngetChar(tmp.lexeme[back]);
-                    tmp.lexeme.erase(back);
-                }
-                tmp.token_type = NUM;
-                tmp.line_no = line_no;
-            }
-            return tmp;
         }
-		return tmp;
     }
-    else //Error Condition
+
+    size_t wave = max(1u, thread::hardware_concurrency());
+    for (size_t first = 0; first < files.size(); first += wave) //A thread & a writer per file, a wave at a time
     {
-        input.UngetChar(b);
-        if (!input.EndOfInput()) 
+        size_t last = min(files.size(), first + wave);
+        vector<TokenWriter*> writers;
+        vector<thread> threads;
+        for (size_t f = first; f < last; f++)
         {
-            input.UngetChar(c);
+            TokenWriter* writer = new TokenWriter(1, format, false);
+            writers.push_back(writer);
+            threads.push_back(thread([writer, &sources, &files, f, format] {
+                LexicalAnalyzer<MappedSource> lexer(sources[f], 1);
+                Token token;
+                do
+                {
+                    token = lexer.GetToken();
+                    writer->Write(token, (format == JSON_TOKENS) ? lexer.Column(lexer.TokenOffset()) : 0);
+                } while (token.token_type != END_OF_FILE);
+                if (lexer.Utf8Error() >= 0) //Lexed all the same, its bad bytes as ERRORs
+                    cerr << files[f] << ": not UTF-8 from byte " << lexer.Utf8Error() << endl;
+            }));
+        }
+        for (size_t k = 0; k < threads.size(); k++)
+        {
+            threads[k].join();
+            delete writers[k]; //Writes the tokens of the file
         }
-        tmp.lexeme = "";
-        tmp.token_type = ERROR;
-        tmp.line_no = line_no;
-        return tmp;
     }
 }
 
-Token LexicalAnalyzer::ScanIdOrKeyword() //Handles ID format
+template <class Source>
+void lex_input(const Source& source, TokenFormat format) //Lexes one input, writing its tokens as it goes
 {
-    char c;
-    input.GetChar(c);
+    LexicalAnalyzer<Source> lexer(source, 1);
+    TokenWriter writer(1, format, true);
+    Token token;
 
-    if (isalpha(c)) 
-	{
-        tmp.lexeme = "";
-        while (!input.EndOfInput() && isalnum(c)) 
-		{
-            tmp.lexeme += c;
-            input.GetChar(c);
-        }
-        if (!input.EndOfInput()) 
-		{
-            input.UngetChar(c);
-        }
-        tmp.line_no = line_no;
-        if (IsKeyword(tmp.lexeme))
-            tmp.token_type = FindKeywordIndex(tmp.lexeme);
-        else
-            tmp.token_type = ID;
-    }
-	else 
-	{
-        if (!input.EndOfInput()) 
-		{
-            input.UngetChar(c);
-        }
-        tmp.lexeme = "";
-        tmp.token_type = ERROR;
+    token = lexer.GetToken();
+    writer.Write(token, (format == JSON_TOKENS) ? lexer.Column(lexer.TokenOffset()) : 0); //Columns are looked up only to be shown
+    while (token.token_type != END_OF_FILE)
+    {
+        token = lexer.GetToken();
+        writer.Write(token, (format == JSON_TOKENS) ? lexer.Column(lexer.TokenOffset()) : 0);
     }
-    return tmp;
+    if (lexer.Utf8Error() >= 0) //Checked as it was read, unless it came through cin
+        cerr << "Not UTF-8 from byte " << lexer.Utf8Error() << endl;
 }
 
-TokenType LexicalAnalyzer::UngetToken(Token tok)
+int main(int argc, char* argv[])
 {
-    tokens.push_back(tok);;
-    return tok.token_type;
-}
-
-Token LexicalAnalyzer::GetToken()
-{
-    char c;
-
-    if (!tokens.empty()) {
-        tmp = tokens.back();
-        tokens.pop_back();
-        return tmp;
-    }
-
-    SkipSpace();
-    tmp.lexeme = "";
-    tmp.line_no = line_no;
-    input.GetChar(c);
-    switch (c) {
-        case '.':
-            tmp.token_type = DOT;
-            return tmp;
-        case '+':
-            tmp.token_type = PLUS;
-            return tmp;
-        case '-':
-            tmp.token_type = MINUS;
-            return tmp;
-        case '/':
-            tmp.token_type = DIV;
-            return tmp;
-        case '*':
-            tmp.token_type = MULT;
-            return tmp;
-        case '=':
-            tmp.token_type = EQUAL;
-            return tmp;
-        case ':':
-            tmp.token_type = COLON;
-            return tmp;
-        case ',':
-            tmp.token_type = COMMA;
-            return tmp;
-        case ';':
-            tmp.token_type = SEMICOLON;
-            return tmp;
-        case '[':
-            tmp.token_type = LBRAC;
-            return tmp;
-        case ']':
-            tmp.token_type = RBRAC;
-            return tmp;
-        case '(':
-            tmp.token_type = LPAREN;
-            return tmp;
-        case ')':
-            tmp.token_type = RPAREN;
-            return tmp;
-        case '<':
-            input.GetChar(c);
-            if (c == '=') //Check for LTEQ
-            {
-                tmp.token_type = LTEQ;
-            } 
-            else if (c == '>') //Check for !=
-            {
-                tmp.token_type = NOTEQUAL;
-            } 
-            else //Check for EOF
-            {
-                if (!input.EndOfInput()) 
-                {
-                    input.UngetChar(c);
-                }
-                tmp.token_type = LESS;
-            }
-            return tmp;
-        case '>':
-            input.GetChar(c);
-            if (c == '=') //Check for GTEQ
-            {
-                tmp.token_type = GTEQ;
-            } 
-            else //Check for EOF
-            {
-                if (!input.EndOfInput()) 
-                {
-                    input.UngetChar(c);
-                }
-                tmp.token_type = GREATER;
-            }
-            return tmp;
-        default:
-            if (isdigit(c)) //Check for Number types
-            {
-                input.UngetChar(c);
-                return ScanNumber();
-            } 
-            else if (isalpha(c)) //Check for ID
-            {
-                input.UngetChar(c);
-                return ScanIdOrKeyword();
-            } 
-            else if (input.EndOfInput()) //Check for EOF
+    TokenFormat format = TEXT_TOKENS;
+    vector<const char*> files;
+    for (int i = 1; i < argc; i++) //Check for options
+    {
+        if (strcmp(argv[i], "-edits") == 0 && i + 1 < argc) //Re-lex after each edit in a file
+        {
+            start_stats("Project1", true);
+            run_edits(argv[i + 1]);
+            return 0;
+        }
+        else if (strcmp(argv[i], "-format") == 0 && i + 1 < argc) //text, binary or json
+        {
+            string name = argv[++i];
+            if (name == "text")
+                format = TEXT_TOKENS;
+            else if (name == "binary")
+                format = BINARY_TOKENS;
+            else if (name == "json")
+                format = JSON_TOKENS;
+            else
             {
-                tmp.token_type = END_OF_FILE;
+                cerr << "Unknown format " << name << endl;
+                return 1;
             }
-            else //Else there is an error
-                tmp.token_type = ERROR;
-
-            return tmp;
+        }
+        else //Lex files instead of standard input
+            files.push_back(argv[i]);
     }
-}
 
-int main()
-{
-    LexicalAnalyzer lexer;
-    Token token;
-
-    token = lexer.GetToken();
-    token.Print();
-    while (token.token_type != END_OF_FILE)
+    start_stats("Project1", files.empty());
+    if (!files.empty())
     {
-        token = lexer.GetToken();
-        token.Print();
+        lex_files(files, format);
+        return 0;
     }
-}
\ No newline at end of file
+
+    if (statsEnabled) //Standard input was read into cin as the input phase
+        lex_input(StreamSource(), format);
+    else
+        lex_input(BlockSource(0), format);
+    return 0;
+}
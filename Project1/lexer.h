@@ -3,8 +3,12 @@
 
 #include <vector>
 #include <string>
+#include <ostream>
+#include <type_traits>
+#include <string.h>
 
-#include "inputbuf.h"
+#include "../common/stats.h"
+#include "../lexcore/lexcore.h"
 
 // ------- token types -------------------
 
@@ -17,32 +21,91 @@ typedef enum { END_OF_FILE = 0,
     DOT, NUM, ID, ERROR, REALNUM, BASE08NUM, BASE16NUM
 } TokenType;
 
+// ------- tokens ------------------------
+
 class Token {
   public:
     void Print();
 
-    std::string lexeme;
+    Lexeme lexeme;
     TokenType token_type;
     int line_no;
 };
 
-class LexicalAnalyzer {
+static_assert(std::is_trivially_copyable<Token>::value, "tokens copy as plain bytes");
+
+// ------- token set ---------------------
+
+//Project1's tokens, for the shared lexer core
+struct projectTokens {
+    typedef Token token;
+    typedef TokenType type;
+
+    static constexpr type endOfFile = END_OF_FILE, error = ERROR, id = ID;
+    static constexpr std::string_view keywords[] = { "IF", "WHILE", "DO", "THEN", "PRINT" };
+    static constexpr punctuator<type> punctuators[] = {
+        { '.', DOT }, { '+', PLUS }, { '-', MINUS }, { '/', DIV }, { '*', MULT }, { '=', EQUAL },
+        { ':', COLON }, { ',', COMMA }, { ';', SEMICOLON }, { '[', LBRAC }, { ']', RBRAC },
+        { '(', LPAREN }, { ')', RPAREN }, { '<', LESS, '=', LTEQ, '>', NOTEQUAL }, { '>', GREATER, '=', GTEQ }
+    };
+    static constexpr numberStyle numbers = BASED_NUMBERS;
+    static constexpr type num = NUM, realNum = REALNUM, base08Num = BASE08NUM, base16Num = BASE16NUM;
+    static constexpr commentStyle comments = NO_COMMENTS; //There are no comments, so // is two DIVs
+    static constexpr type loneSlash = DIV;
+    static constexpr bool pairUngetsAtEnd = false;
+    static constexpr bool keywordPrefixes = false;
+};
+
+//Lexes the characters of a Source; built for StreamSource, StringSource, MappedSource & BlockSource
+template <class Source = StreamSource>
+using LexicalAnalyzer = LexerCore<projectTokens, Source>;
+
+// ------- incremental re-lexing ---------
+
+//A token of a TokenStream & the bytes it came from
+struct StreamToken {
+    Token token;
+    int offset;   //First byte
+    int end;      //One past the last byte
+    int reach;    //Furthest byte looked at for it or any token before it
+};
+
+//Tokens of a text kept in memory; an edit re-lexes from the first token that looked at the edited
+//bytes until the new tokens line up with the old ones again
+class TokenStream {
   public:
-    Token GetToken();
-    TokenType UngetToken(Token);
-    LexicalAnalyzer();
+    void Lex(const std::string&);
+    int Edit(int, int, const std::string&); //Replaces bytes & returns how many tokens were lexed again
+    const std::string& Text();
+
+    std::vector<StreamToken> tokens; //Ends with END_OF_FILE
 
   private:
-    std::vector<Token> tokens;
-    int line_no;
-    Token tmp;
-    InputBuffer input;
-
-    bool SkipSpace();
-    bool IsKeyword(std::string);
-    TokenType FindKeywordIndex(std::string);
-    Token ScanIdOrKeyword();
-    Token ScanNumber();
+    std::string text;
+    StreamToken Next(LexicalAnalyzer<StringSource>&, int);
+};
+
+// ------- token output ------------------
+
+enum TokenFormat { TEXT_TOKENS, BINARY_TOKENS, JSON_TOKENS };
+
+//Formats tokens into a large buffer written to a file descriptor in blocks. Each lexing thread uses its
+//own writer; every write to a descriptor holds one lock, so blocks from different writers never tear.
+class TokenWriter {
+  public:
+    TokenWriter(int, TokenFormat, bool); //Descriptor, format & whether to write out each time the buffer fills
+    ~TokenWriter();
+    void Write(const Token&, int); //A token & its column, which only JSON shows
+    void Flush();
+
+  private:
+    int fd;
+    TokenFormat format;
+    bool streaming;
+    std::vector<char> buffer;
+    size_t used;
+
+    char* Reserve(size_t);
 };
 
 #endif  //__LEXER__H__
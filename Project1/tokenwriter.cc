@@ -0,0 +1,174 @@
+#include <vector>
+#include <string>
+#include <mutex>
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lexer.h"
+#include "../common/stats.h"
+
+using namespace std;
+
+extern string reserved[];
+
+#define TYPE_COUNT (BASE16NUM + 1)
+#define WRITER_BUFFER (1 << 16)
+
+struct typeFragments { //What goes between the lexeme & the line for each token type
+    string text[TYPE_COUNT];  // , TYPE ,
+    string json[TYPE_COUNT];  //","type":"TYPE","line":
+};
+
+static mutex outputLock; //Held by every write to a descriptor
+
+static const typeFragments& fragments() //Built once, by whichever writer comes first
+{
+    static typeFragments built = [] {
+        typeFragments f;
+        for (int t = 0; t < TYPE_COUNT; t++)
+        {
+            f.text[t] = " , " + reserved[t] + " , ";
+            f.json[t] = "\",\"type\":\"" + reserved[t] + "\",\"line\":";
+        }
+        return f;
+    }();
+    return built;
+}
+
+static char* put_number(char* p, int n) //Writes n in decimal
+{
+    char digits[12];
+    int count = 0;
+    unsigned int u = n;
+    if (n < 0)
+    {
+        *p++ = '-';
+        u = 0u - u;
+    }
+    do
+    {
+        digits[count++] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+    while (count > 0)
+        *p++ = digits[--count];
+    return p;
+}
+
+static char* put_bytes(char* p, const string& s) //Copies a string
+{
+    memcpy(p, s.data(), s.size());
+    return p + s.size();
+}
+
+static char* put_bytes(char* p, const Lexeme& s) //Copies a lexeme
+{
+    memcpy(p, s.data(), s.size());
+    return p + s.size();
+}
+
+TokenWriter::TokenWriter(int fd, TokenFormat format, bool streaming) //Constructor
+{
+    this->fd = fd;
+    this->format = format;
+    this->streaming = streaming;
+    buffer.resize(WRITER_BUFFER);
+    used = 0;
+    fragments();
+}
+
+TokenWriter::~TokenWriter() //Writes out what is left
+{
+    Flush();
+}
+
+char* TokenWriter::Reserve(size_t n) //Makes room for n more bytes & returns where they go
+{
+    if (used + n > buffer.size() && streaming)
+        Flush();
+    if (used + n > buffer.size())
+        buffer.resize(max(buffer.size() * 2, used + n));
+    return &buffer[used];
+}
+
+void TokenWriter::Write(const Token& token, int column) //Formats one token at the end of the buffer
+{
+    phaseTimer printing(PHASE_OUTPUT);
+    const typeFragments& f = fragments();
+    const Lexeme& lexeme = token.lexeme;
+    char* p = buffer.data() + used; //Where the token goes; a format not below writes nothing
+
+    switch (format) {
+        case TEXT_TOKENS: //{lexeme , TYPE , line}, like Token::Print
+            p = Reserve(lexeme.size() + f.text[token.token_type].size() + 16);
+            *p++ = '{';
+            p = put_bytes(p, lexeme);
+            p = put_bytes(p, f.text[token.token_type]);
+            p = put_number(p, token.line_no);
+            *p++ = '}';
+            *p++ = '\n';
+            break;
+        case BINARY_TOKENS: //Type byte, line & lexeme length as 4-byte native ints, then the lexeme
+        {
+            int line = token.line_no;
+            unsigned int length = lexeme.size();
+            p = Reserve(lexeme.size() + 9);
+            *p++ = (char) token.token_type;
+            memcpy(p, &line, 4);
+            memcpy(p + 4, &length, 4);
+            p = put_bytes(p + 8, lexeme);
+            break;
+        }
+        case JSON_TOKENS: //One object per line
+            p = Reserve(lexeme.size() * 6 + f.json[token.token_type].size() + 56);
+            memcpy(p, "{\"lexeme\":\"", 11);
+            p += 11;
+            for (size_t i = 0; i < lexeme.size(); i++)
+            {
+                unsigned char c = lexeme[i];
+                if (c == '"' || c == '\\')
+                {
+                    *p++ = '\\';
+                    *p++ = c;
+                }
+                else if (c < 0x20) //Control characters as \u00XX
+                {
+                    *p++ = '\\';
+                    *p++ = 'u';
+                    *p++ = '0';
+                    *p++ = '0';
+                    *p++ = "0123456789abcdef"[c >> 4];
+                    *p++ = "0123456789abcdef"[c & 15];
+                }
+                else
+                    *p++ = c;
+            }
+            p = put_bytes(p, f.json[token.token_type]);
+            p = put_number(p, token.line_no);
+            memcpy(p, ",\"column\":", 10);
+            p = put_number(p + 10, column);
+            *p++ = '}';
+            *p++ = '\n';
+            break;
+    }
+    used = p - &buffer[0];
+}
+
+void TokenWriter::Flush() //Writes the buffer to the descriptor as one block
+{
+    phaseTimer printing(PHASE_OUTPUT);
+    lock_guard<mutex> lock(outputLock);
+    size_t done = 0;
+    while (done < used)
+    {
+        ssize_t n = write(fd, &buffer[done], used - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) //Nowhere to write it
+            break;
+        done += n;
+    }
+    used = 0;
+}
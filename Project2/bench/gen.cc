@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <vector>
+
+#include "../../common/gen.h"
+
+using namespace std;
+
+unsigned long long seed = 1;
+long long outputSize = 1 << 20; //Bytes to write
+int depth = 4;      //Most scopes open at once
+int decls = 4;      //Globals & variables in each public or private list
+int nest = 15;      //Percent of statements that are scopes
+int reuse = 90;     //Percent of names in statements that are declared, the rest resolving to ?.
+int globals = 30;   //Percent of declared names that are globals
+int comments = 5;   //Percent of statements with a comment line before them
+
+//A scope still open & the variables it declared
+struct openScope
+{
+    vector<long long> vars;
+    int statements;
+};
+
+//Sets the knobs of a preset
+bool preset(const char* name)
+{
+    if (strcmp(name, "deep") == 0) //Scopes nested as deep as they go, so parse_scope recurses that far
+    {
+        depth = 1000000;
+        decls = 1;
+        nest = 100;
+        return true;
+    }
+    if (strcmp(name, "scan") == 0) //Many globals named from deep inside, so find_scope walks the whole table
+    {
+        depth = 8;
+        decls = 2000;
+        globals = 90;
+        reuse = 100;
+        return true;
+    }
+    return strcmp(name, "default") == 0;
+}
+
+//Writes a list of new variables like v1, v2, v3 & records them
+void put_var_list(genOutput& out, genRandom& random, vector<long long>& vars, long long& made)
+{
+    int count = 1 + random.Below(decls);
+    for (int i = 0; i < count; i++)
+    {
+        if (i > 0)
+            out.Put(", ");
+        out.Name("v", made);
+        vars.push_back(made++);
+    }
+    out.Put(";\n");
+}
+
+//Writes spaces for a depth, at most 16
+void put_indent(genOutput& out, int level)
+{
+    out.Put("                                ", 2 * (level < 16 ? level : 16));
+}
+
+//Writes a name for an assignment: a global, a variable of an open scope or an undeclared one
+void put_use(genOutput& out, genRandom& random, vector<long long>& global, vector<openScope>& scopes)
+{
+    if (random.Percent(reuse))
+    {
+        vector<long long>* vars = &global;
+        if (!random.Percent(globals) || global.empty())
+            vars = &scopes[random.Below(scopes.size())].vars;
+        if (!vars->empty())
+        {
+            out.Name("v", (*vars)[random.Below(vars->size())]);
+            return;
+        }
+    }
+    out.Name("u", random.Below(1000));
+}
+
+//Writes scopes of assignments & nested scopes until size bytes are out, then closes them
+int main(int argc, char* argv[])
+{
+    vector<genKnob> knobs = {
+        { "depth", &depth, "most scopes open at once" },
+        { "decls", &decls, "most variables in the global, public & private lists" },
+        { "nest", &nest, "percent of statements that are scopes" },
+        { "reuse", &reuse, "percent of names in statements that are declared" },
+        { "globals", &globals, "percent of declared names that are globals" },
+        { "comments", &comments, "percent of statements with a comment before them" },
+    };
+    if (!read_knobs(argc, argv, seed, outputSize, knobs, "default|deep|scan", preset))
+        return 1;
+
+    genRandom random(seed);
+    genOutput out;
+    vector<long long> global;
+    vector<openScope> scopes;
+    long long made = 0;
+    long long scopesMade = 0;
+
+    if (decls > 0)
+        put_var_list(out, random, global, made);
+    do
+    {
+        int level = scopes.size();
+        if (level == 0 || (level < depth && random.Percent(nest))) //Open a scope, with its lists
+        {
+            if (level > 0)
+                scopes.back().statements++;
+            put_indent(out, level);
+            out.Name("s", scopesMade++);
+            out.Put(" {\n");
+            scopes.push_back(openScope());
+            scopes.back().statements = 0;
+            if (decls > 0 && random.Percent(70))
+            {
+                put_indent(out, level + 1);
+                out.Put("public: ");
+                put_var_list(out, random, scopes.back().vars, made);
+            }
+            if (decls > 0 && random.Percent(50))
+            {
+                put_indent(out, level + 1);
+                out.Put("private: ");
+                put_var_list(out, random, scopes.back().vars, made);
+            }
+            continue;
+        }
+
+        if (random.Percent(comments))
+        {
+            put_indent(out, level);
+            out.Put("// statement ");
+            out.Number(scopes.back().statements);
+            out.Put("\n");
+        }
+        put_indent(out, level);
+        put_use(out, random, global, scopes);
+        out.Put(" = ");
+        put_use(out, random, global, scopes);
+        out.Put(";\n");
+        scopes.back().statements++;
+
+        if (level > 1 && random.Percent(15)) //Close the scope
+        {
+            scopes.pop_back();
+            put_indent(out, level - 1);
+            out.Put("}\n");
+        }
+    } while (out.written < outputSize);
+
+    while (!scopes.empty()) //A scope needs a statement before it closes
+    {
+        if (scopes.back().statements == 0)
+        {
+            put_indent(out, scopes.size());
+            put_use(out, random, global, scopes);
+            out.Put(" = ");
+            put_use(out, random, global, scopes);
+            out.Put(";\n");
+        }
+        scopes.pop_back();
+        put_indent(out, scopes.size());
+        out.Put("}\n");
+    }
+    return 0;
+}
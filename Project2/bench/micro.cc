@@ -0,0 +1,161 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "../lexer.h"
+#include "../parser.h"
+#include "../tokengen.h"
+#include "../../common/harness.h"
+
+using namespace std;
+
+#define BENCH_TEXT (1 << 18) //Bytes of input per run
+#define SCOPES 10
+#define SCOPE_VARS 20        //Variables declared in each scope & globally
+#define LOOKUPS 1000
+#define BENCH_CHUNK (1 << 16) //Bytes fed to the coroutine lexer at a time
+
+//Reaches the scanners GetToken calls & the scope resolution of the parser, so each is timed on its own
+struct benchAccess
+{
+    static bool SkipSpace(LexicalAnalyzer& lexer) { return lexer.SkipSpace(); }
+    static Token ScanIdOrKeyword(LexicalAnalyzer& lexer) { return lexer.ScanIdOrKeyword(); }
+    static void GetChar(LexicalAnalyzer& lexer, char& c) { lexer.input.GetChar(c); }
+    static string find_scope(Parser& parser, const string& id) { return parser.find_scope(id); }
+    static void enter_scope(Parser& parser, const string& scope) { parser.currentScope = scope; }
+};
+
+stringbuf source;
+LexicalAnalyzer* lexer = NULL;
+
+//Points standard input at a text & starts a new lexer on it
+void lex_text(const string& text)
+{
+    source.str(text);
+    cin.rdbuf(&source);
+    cin.clear();
+    delete lexer;
+    lexer = new LexicalAnalyzer();
+}
+
+//Declares the globals, then each scope's public & private variables, like parse_var_list does
+void declare_scopes(Parser& parser)
+{
+    parser.table = new struct scopeTable();
+    for (int s = -1; s < SCOPES; s++)
+    {
+        for (int v = 0; v < SCOPE_VARS; v++)
+        {
+            struct scopeTable* newTable = new struct scopeTable;
+            newTable->item.scope = (s < 0) ? "::" : "s" + to_string(s);
+            newTable->item.name = ((s < 0) ? "g" : "v") + to_string(v);
+            newTable->item.ispublic = (v % 2 == 0);
+            newTable->next = parser.table;
+            parser.table = newTable;
+        }
+    }
+}
+
+//Resolves LOOKUPS names from the last scope declared
+benchCase scope_case(const string& name, Parser& parser, const string& prefix)
+{
+    return { name, LOOKUPS, 0,
+             [&parser] { benchAccess::enter_scope(parser, "s" + to_string(SCOPES - 1)); },
+             [&parser, prefix] {
+                 for (int i = 0; i < LOOKUPS; i++)
+                     benchAccess::find_scope(parser, prefix + to_string(i % SCOPE_VARS));
+             } };
+}
+
+//Driver Code
+int main(int argc, char* argv[])
+{
+    vector<benchCase> cases;
+    string texts[4];
+    InputBuffer<StreamSource>* input = NULL;
+
+    texts[0] = repeat_text("a1, b2;\n  c3 = d4;\n", BENCH_TEXT);
+    cases.push_back({ "InputBuffer::GetChar", (long long) texts[0].size(), (long long) texts[0].size(),
+                      [&] {
+                          lex_text(texts[0]);
+                          delete input;
+                          input = new InputBuffer<StreamSource>();
+                      },
+                      [&] {
+                          char c;
+                          for (size_t i = 0; i < texts[0].size(); i++)
+                              input->GetChar(c);
+                      } });
+
+    texts[1] = repeat_text("  \t\n    x", BENCH_TEXT);
+    long long runs = texts[1].size() / 9;
+    cases.push_back({ "SkipSpace", runs, (long long) texts[1].size(),
+                      [&] { lex_text(texts[1]); },
+                      [runs] {
+                          char c;
+                          for (long long i = 0; i < runs; i++)
+                          {
+                              benchAccess::SkipSpace(*lexer);
+                              benchAccess::GetChar(*lexer, c); //The x ending each run of spaces
+                          }
+                      } });
+
+    string piece = "alpha public b2 private scope1 ";
+    texts[2] = repeat_text(piece, BENCH_TEXT);
+    long long words = texts[2].size() / piece.size() * count(piece.begin(), piece.end(), ' ');
+    cases.push_back({ "ScanIdOrKeyword", words, (long long) texts[2].size(),
+                      [&] { lex_text(texts[2]); },
+                      [words] {
+                          for (long long i = 0; i < words; i++)
+                          {
+                              benchAccess::ScanIdOrKeyword(*lexer);
+                              benchAccess::SkipSpace(*lexer);
+                          }
+                      } });
+
+    //Whole tokens, lexed by GetToken & by the coroutine lexer fed in chunks
+    texts[3] = repeat_text("a1, b2;\n  s1 { public: c3; private: d4;\n  // note\n  c3 = a1;\n}\n", BENCH_TEXT);
+    long long tokens = 0;
+    lex_text(texts[3]);
+    while (lexer->GetToken().token_type != END_OF_FILE)
+        tokens++;
+    cases.push_back({ "GetToken", tokens, (long long) texts[3].size(),
+                      [&] { lex_text(texts[3]); },
+                      [] {
+                          while (lexer->GetToken().token_type != END_OF_FILE)
+                              ;
+                      } });
+    cases.push_back({ "TokenGenerator::Next", tokens, (long long) texts[3].size(),
+                      [] {},
+                      [&texts] {
+                          TokenGenerator generator = generate_tokens();
+                          size_t fed = 0;
+                          Token t;
+                          while (true)
+                          {
+                              if (generator.Next(t))
+                              {
+                                  if (t.token_type == END_OF_FILE)
+                                      break;
+                              }
+                              else if (fed < texts[3].size())
+                              {
+                                  size_t size = min((size_t) BENCH_CHUNK, texts[3].size() - fed);
+                                  generator.Feed(texts[3].data() + fed, size);
+                                  fed += size;
+                              }
+                              else
+                                  generator.Finish();
+                          }
+                      } });
+
+    Parser parser;
+    declare_scopes(parser);
+    cases.push_back(scope_case("find_scope/local", parser, "v"));
+    cases.push_back(scope_case("find_scope/global", parser, "g"));
+    cases.push_back(scope_case("find_scope/unresolved", parser, "u"));
+
+    return run_benchmarks("Project2", cases, argc, argv);
+}
@@ -3,9 +3,16 @@
 #include <vector>
 #include <string>
 #include <cctype>
+#include <unordered_map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "lexer.h"
-#include "inputbuf.h"
+#include "../common/stats.h"
 
 using namespace std;
 
@@ -16,9 +23,6 @@ string reserved[] =
     "LBRACE", "RBRACE", "ID", "ERROR"
 };
 
-#define KEYWORDS_COUNT 2
-string keyword[] = { "public", "private" };
-
 void Token::Print() //Formatted Print
 {
     cout << "{" << this->lexeme << " , "
@@ -26,186 +30,109 @@ void Token::Print() //Formatted Print
          << this->line_no << "}\n";
 }
 
-LexicalAnalyzer::LexicalAnalyzer() //Constructor
+LexicalAnalyzer::LexicalAnalyzer() //Constructor; the core starts on line 1
 {
-    this->line_no = 1;
-    tmp.lexeme = "";
-    tmp.line_no = 1;
-    tmp.token_type = ERROR;
+    records = NULL;
+    pool = NULL;
+    recordCount = poolSize = nextRecord = 0;
+    generator = NULL;
 }
 
-bool LexicalAnalyzer::SkipSpace() //Assists with skipping spaces
+Token LexicalAnalyzer::GetToken() //Next token from the token file, the coroutine lexer or the shared lexer core
 {
-    char c;
-    bool space_encountered = false;
-
-    input.GetChar(c);
-    line_no += (c == '\n');
-
-    while (!input.EndOfInput() && isspace(c)) 
-	{
-        space_encountered = true;
-        input.GetChar(c);
-        line_no += (c == '\n');
-    }
-
-    if (!input.EndOfInput()) 
-	{
-        input.UngetChar(c);
+    if (!tokens.empty()) {
+        tmp = tokens.back();
+        tokens.pop_back();
+        return tmp;
     }
-    return space_encountered;
+    phaseTimer scan(PHASE_SCAN);
+    if (records != NULL) //Read from a token file instead
+        return ReplayToken();
+    if (generator != NULL) //Pull from the coroutine lexer instead
+        return PulledToken();
+    return Scan();
 }
 
-Token LexicalAnalyzer::SkipComment() //Assists with skipping over comments
+bool LexicalAnalyzer::WriteTokens(const char* path) //Lexes the rest of the input into a token file, with each lexeme kept once in the pool
 {
-	char c;
-	input.GetChar(c);
-	
-	while(!input.EndOfInput() && c != '\n') //Skip to end of line
-		input.GetChar(c);
-	line_no++; //Increment line number
-	
-	if(!input.EndOfInput())
-		input.UngetChar(c);
-	
-	return GetToken(); //Begin again
-}
+    vector<tokenRecord> list;
+    string lexemes;
+    unordered_map<string, unsigned int> interned;
+    Token t;
 
-bool LexicalAnalyzer::IsKeyword(string s)
-{
-    for (int i = 0; i < KEYWORDS_COUNT; i++) 
+    do
 	{
-        if (s == keyword[i])
-		{
-            return true;
-        }
-    }
-    return false;
+        t = GetToken();
+        if (t.lexeme.size() >= (1u << 24)) //No room for the length
+            return false;
+        pair<unordered_map<string, unsigned int>::iterator, bool> entry = interned.emplace(t.lexeme.str(), lexemes.size());
+        if (entry.second) //First time this lexeme is seen
+            lexemes.append(t.lexeme.data(), t.lexeme.size());
+        tokenRecord record = { (unsigned int) t.line_no, entry.first->second,
+                               ((unsigned int) t.token_type << 24) | (unsigned int) t.lexeme.size() };
+        list.push_back(record);
+    } while (t.token_type != END_OF_FILE);
+
+    tokenFileHeader header = { TOKEN_FILE_MAGIC, TOKEN_FILE_VERSION, TOKEN_SET, (unsigned int) list.size(),
+                               (unsigned int) lexemes.size() };
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(list.data(), sizeof(tokenRecord), list.size(), file) == list.size() &&
+                   fwrite(lexemes.data(), 1, lexemes.size(), file) == lexemes.size();
+    return (fclose(file) == 0) && written;
 }
 
-TokenType LexicalAnalyzer::FindKeywordIndex(string s)
+bool LexicalAnalyzer::MapTokens(const char* path) //Maps a token file so GetToken reads its records instead of the input
 {
-    for (int i = 0; i < KEYWORDS_COUNT; i++) 
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat info;
+    void* map = MAP_FAILED;
+    if (fstat(file, &info) == 0 && (size_t) info.st_size >= sizeof(tokenFileHeader))
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file); //The mapping stays until exit
+    if (map == MAP_FAILED)
+        return false;
+
+    const tokenFileHeader* header = (const tokenFileHeader*) map;
+    const tokenRecord* list = (const tokenRecord*) (header + 1);
+    bool valid = header->magic == TOKEN_FILE_MAGIC && header->version == TOKEN_FILE_VERSION &&
+                 header->tokenSet == TOKEN_SET && header->count > 0 &&
+                 sizeof(tokenFileHeader) + (unsigned long long) header->count * sizeof(tokenRecord) + header->poolSize ==
+                     (unsigned long long) info.st_size &&
+                 (list[header->count - 1].typeLength >> 24) == END_OF_FILE; //The last record has to stop the parser
+    if (!valid) 
 	{
-        if (s == keyword[i])
-		{
-            return (TokenType) (i + 1);
-        }
+        munmap(map, info.st_size);
+        return false;
     }
-    return ERROR;
+
+    records = list;
+    pool = (const char*) (list + header->count);
+    recordCount = header->count;
+    poolSize = header->poolSize;
+    nextRecord = 0;
+    return true;
 }
 
-Token LexicalAnalyzer::ScanIdOrKeyword() //Handles ID format
+Token LexicalAnalyzer::ReplayToken() //Gets the next token from the mapped file; the last one repeats, like the lexer at the end of its input
 {
-    char c;
-    input.GetChar(c);
+    const tokenRecord& record = records[nextRecord];
+    if (nextRecord + 1 < recordCount)
+        nextRecord++;
 
-    if (isalpha(c)) 
+    unsigned int type = record.typeLength >> 24;
+    unsigned int length = record.typeLength & 0xffffff;
+    if (type > ERROR || record.lexeme > poolSize || length > poolSize - record.lexeme) //Damaged file
 	{
-        tmp.lexeme = "";
-        while (!input.EndOfInput() && isalnum(c)) 
-		{
-            tmp.lexeme += c;
-            input.GetChar(c);
-        }
-        if (!input.EndOfInput()) 
-		{
-            input.UngetChar(c);
-        }
-        tmp.line_no = line_no;
-        if (IsKeyword(tmp.lexeme))
-            tmp.token_type = FindKeywordIndex(tmp.lexeme);
-        else
-            tmp.token_type = ID;
-    }
-	else 
-	{
-        if (!input.EndOfInput()) 
-		{
-            input.UngetChar(c);
-        }
-        tmp.lexeme = "";
-        tmp.token_type = ERROR;
+        cerr << "Bad record in token file" << endl;
+        exit(1);
     }
+    tmp.lexeme.assign(pool + record.lexeme, length);
+    tmp.token_type = (TokenType) type;
+    tmp.line_no = record.line_no;
     return tmp;
 }
-
-TokenType LexicalAnalyzer::UngetToken(Token tok) //Pushes back the token
-{
-    tokens.push_back(tok);;
-    return tok.token_type;
-}
-
-Token LexicalAnalyzer::GetToken()
-{
-    char c;
-
-    if (!tokens.empty()) {
-        tmp = tokens.back();
-        tokens.pop_back();
-        return tmp;
-    }
-
-    SkipSpace();
-    tmp.lexeme = "";
-    tmp.line_no = line_no;
-    input.GetChar(c);
-    switch (c) {
-        case '/': //Check for comment
-            char b;
-			input.GetChar(b);
-			if(b == '/')
-				return SkipComment();
-			else
-				input.UngetChar(b);
-        case '=': //Check for equal
-            tmp.token_type = EQUAL;
-            return tmp;
-        case ':': //Check for colon
-            tmp.token_type = COLON;
-            return tmp;
-        case ',': //Check for comma
-            tmp.token_type = COMMA;
-            return tmp;
-        case ';': //Check for semicolon
-            tmp.token_type = SEMICOLON;
-            return tmp;
-        case '{': //Check for Left Brace
-            tmp.token_type = LBRACE;
-            return tmp;
-        case '}': //Check for Right Brace
-            tmp.token_type = RBRACE;
-            return tmp;
-		case 'p': //Check for public or private
-			char d, e, f, g, h, i; //Create temp storage
-			input.GetChar(d); input.GetChar(e); input.GetChar(f); input.GetChar(g); input.GetChar(h); //Collect chars
-			
-			if(d == 'u' && e == 'b' && f == 'l' && g == 'i' && h == 'c') //Check for public
-			{
-				tmp.token_type = PUBLIC;
-				return tmp;
-			}
-			input.GetChar(i); //Collect e
-			if(d == 'r' && e == 'i' && f == 'v' && g == 'a' && h == 't' && i == 'e') //Check for private
-			{
-				tmp.token_type = PRIVATE;
-				return tmp;
-			}
-			input.UngetChar(i); input.UngetChar(h); input.UngetChar(g); //Return letters except c
-			input.UngetChar(f); input.UngetChar(e); input.UngetChar(d);
-        default:
-			if (isalpha(c)) //Check for ID
-            {
-                input.UngetChar(c);
-                return ScanIdOrKeyword();
-            } 
-            else if (input.EndOfInput()) //Check for EOF
-            {
-                tmp.token_type = END_OF_FILE;
-            }
-            else //Else there is an error
-                tmp.token_type = ERROR;
-
-            return tmp;
-    }
-}
\ No newline at end of file
@@ -3,8 +3,12 @@
 
 #include <vector>
 #include <string>
+#include <ostream>
+#include <type_traits>
+#include <string.h>
 
-#include "inputbuf.h"
+#include "../common/stats.h"
+#include "../lexcore/lexcore.h"
 
 // ------- token types -------------------
 
@@ -15,32 +19,84 @@ typedef enum {
 	LBRACE, RBRACE, ID, ERROR
 } TokenType;
 
+// ------- tokens ------------------------
+
 class Token {
   public:
     void Print();
 
-    std::string lexeme;
+    Lexeme lexeme;
     TokenType token_type;
     int line_no;
 };
 
-class LexicalAnalyzer {
+static_assert(std::is_trivially_copyable<Token>::value, "tokens copy as plain bytes");
+
+// ------- token files -------------------
+
+#define TOKEN_FILE_MAGIC 0x4e4b4f5430343343ULL //"C340TOKN"
+#define TOKEN_FILE_VERSION 1
+#define TOKEN_SET 2                            //Project2 tokens; other token sets are rejected
+
+struct tokenFileHeader { //Start of a token file, followed by the records & the lexeme pool
+    unsigned long long magic;
+    unsigned int version;
+    unsigned int tokenSet;
+    unsigned int count;      //Records, the last being END_OF_FILE
+    unsigned int poolSize;   //Bytes of interned lexemes
+};
+
+struct tokenRecord { //One token: its lexeme is pool[lexeme, lexeme + length)
+    unsigned int line_no;
+    unsigned int lexeme;
+    unsigned int typeLength; //Type in the top 8 bits, length below
+};
+
+class TokenGenerator; //Coroutine lexer, in tokengen.h
+
+// ------- token set ---------------------
+
+//Project2's tokens, for the shared lexer core
+struct projectTokens {
+    typedef Token token;
+    typedef TokenType type;
+
+    static constexpr type endOfFile = END_OF_FILE, error = ERROR, id = ID;
+    static constexpr std::string_view keywords[] = { "public", "private" };
+    static constexpr punctuator<type> punctuators[] = {
+        { '=', EQUAL }, { ':', COLON }, { ',', COMMA }, { ';', SEMICOLON }, { '{', LBRACE }, { '}', RBRACE }
+    };
+    static constexpr numberStyle numbers = NO_NUMBERS;
+    static constexpr type num = ERROR, realNum = ERROR, base08Num = ERROR, base16Num = ERROR;
+    static constexpr commentStyle comments = LINE_COMMENTS;
+    static constexpr type loneSlash = EQUAL;
+    static constexpr bool pairUngetsAtEnd = false;
+    static constexpr bool keywordPrefixes = true; //publicx is PUBLIC then x
+};
+
+extern template class LexerCore<projectTokens, StreamSource>; //Built optimized in scanner.cc
+
+class LexicalAnalyzer : public LexerCore<projectTokens> {
   public:
     Token GetToken();
-    TokenType UngetToken(Token);
+    bool WriteTokens(const char*);
+    bool MapTokens(const char*);
+    void PullTokens(size_t); //Lexes with the coroutine lexer, fed chunks of the input of at most a size
     LexicalAnalyzer();
 
   private:
-    std::vector<Token> tokens;
-    int line_no;
-    Token tmp;
-    InputBuffer input;
-
-    bool SkipSpace();
-    bool IsKeyword(std::string);
-    TokenType FindKeywordIndex(std::string);
-	Token SkipComment();
-    Token ScanIdOrKeyword();
+    const tokenRecord* records; //Mapped token file GetToken reads instead of the input, or NULL
+    const char* pool;
+    unsigned int recordCount;
+    unsigned int poolSize;
+    unsigned int nextRecord;
+    TokenGenerator* generator; //Coroutine lexer GetToken pulls from instead of lexing itself, or NULL
+    std::vector<char> chunk;
+
+    Token ReplayToken();
+    Token PulledToken();
+
+    friend struct benchAccess; //The micro benchmarks time the scanners on their own
 };
 
 #endif  //__LEXER__H__
\ No newline at end of file
@@ -4,10 +4,12 @@
 #include <string>
 #include <cctype>
 #include <stdlib.h>
+#include <string.h>
 
 #include "lexer.h"
-#include "inputbuf.h"
 #include "parser.h"
+#include "../common/stats.h"
+#include "../common/trace.h"
 
 //Forward Declarations
 void syntax_error();
@@ -17,6 +19,7 @@ using namespace std;
 //Parses the program
 void Parser::parse_program()
 {
+    traceSpan span(__func__);
 	currentScope = "::"; //Prepare scopes
     scopes.push(currentScope);
     Token t1 = lexer.GetToken();
@@ -45,6 +48,7 @@ void Parser::parse_program()
 
 //Parse the global_vars
 void Parser::parse_global_vars() {
+    traceSpan span(__func__);
     Token t1 = lexer.GetToken();
     if (t1.token_type == ID)
 	{
@@ -61,6 +65,7 @@ void Parser::parse_global_vars() {
 //Parse the var_list
 void Parser::parse_var_list(bool ispublic)
 {
+    traceSpan span(__func__);
     Token token = lexer.GetToken();
     if (token.token_type == ID)
 	{
@@ -91,6 +96,7 @@ void Parser::parse_var_list(bool ispublic)
 //Parse the Scope
 void Parser::parse_scope()
 {
+    traceSpan span(__func__);
     Token t1 = lexer.GetToken();
 	Token t2 = lexer.GetToken();
     if (t1.token_type == ID && t2.token_type == LBRACE) //Check ID and LBRACE
@@ -116,6 +122,7 @@ void Parser::parse_scope()
 //Check and parse for public vars
 void Parser::parse_public_vars()
 {
+    traceSpan span(__func__);
     Token t1 = lexer.GetToken();
     if (t1.token_type == PUBLIC) //Look for Public token
 	{
@@ -137,6 +144,7 @@ void Parser::parse_public_vars()
 //Check and parse for private vars
 void Parser::parse_private_vars()
 {
+    traceSpan span(__func__);
     Token t1 = lexer.GetToken();
     if (t1.token_type == PRIVATE) //Look for Private token
 	{
@@ -159,6 +167,7 @@ void Parser::parse_private_vars()
 //Parse the statement list
 void Parser::parse_statement_list()
 {
+    traceSpan span(__func__);
     Token t1 = lexer.GetToken();
     if (t1.token_type == ID) //Check for ID in statement
 	{
@@ -194,6 +203,7 @@ void Parser::parse_statement_list()
 //Parses the statements
 void Parser::parse_statement()
 {
+    traceSpan span(__func__);
     Token t1 = lexer.GetToken();
     if (t1.token_type == ID) //Check for ID
 	{
@@ -223,16 +233,19 @@ void Parser::parse_statement()
 //Handles printing of statements
 void Parser::print_parse_statement(string t1, string t2)
 {
+    phaseTimer printing(PHASE_OUTPUT);
 	cout << find_scope(t1) << t1 << " = " << find_scope(t2) << t2 << endl;
 }
 
 //Finds the scope current token belongs to
 string Parser::find_scope(string id)
 {
+    phaseTimer lookup(PHASE_LOOKUP);
     struct scopeTable currItem = *table; //Iterator
     
 	while (!((currItem.item.name.empty() || currItem.next == NULL) ||(currItem.item.name == id && (currItem.item.scope == currentScope || currItem.item.ispublic))))
 	{
+        STAT_COUNT(SCOPE_PROBES);
         currItem = *currItem.next;
     }
 	
@@ -244,6 +257,18 @@ string Parser::find_scope(string id)
         return "?.";
 }
 
+//Parses the tokens of a file instead of the input
+bool Parser::read_tokens(const char* path)
+{
+    return lexer.MapTokens(path);
+}
+
+//Lexes with the coroutine lexer, fed the input in chunks
+void Parser::pull_tokens(size_t chunkSize)
+{
+    lexer.PullTokens(chunkSize);
+}
+
 //Handles syntax errors
 void syntax_error()
 {
@@ -251,11 +276,79 @@ void syntax_error()
     exit(1);
 }
 
+//Lexes the input again & compares it with a token file record by record
+int check_token_file(const char* path)
+{
+    LexicalAnalyzer fileTokens;
+    if (!fileTokens.MapTokens(path))
+    {
+        cout << "Not a version " << TOKEN_FILE_VERSION << " Project2 token file: " << path << endl;
+        return 1;
+    }
+	
+    LexicalAnalyzer inputTokens;
+    for (int i = 0; ; i++)
+    {
+        Token a = fileTokens.GetToken();
+        Token b = inputTokens.GetToken();
+        if (a.token_type != b.token_type || a.lexeme != b.lexeme || a.line_no != b.line_no)
+        {
+            cout << "Token " << i << " differs\n  file:  ";
+            a.Print();
+            cout << "  input: ";
+            b.Print();
+            int at = inputTokens.TokenOffset();
+            cout << "  at line " << inputTokens.Line(at) << ", column " << inputTokens.Column(at) << " of the input\n";
+            return 1;
+        }
+        if (a.token_type == END_OF_FILE)
+        {
+            cout << "Token file matches the input: " << i + 1 << " tokens\n";
+            return 0;
+        }
+    }
+}
+
 //Code Driver
-int main()
+int main(int argc, char* argv[])
 {
+    const char* tokenOutput = NULL; //Save the tokens of the input to a file, then parse them
+    const char* tokenInput = NULL;  //Parse the tokens of a file instead of the input
+    int chunkSize = 0;
+    for (int i = 1; i + 1 < argc; i++) //Check for options
+    {
+        if (strcmp(argv[i], "-tokens-out") == 0)
+            tokenOutput = argv[++i];
+        else if (strcmp(argv[i], "-tokens-in") == 0)
+            tokenInput = argv[++i];
+        else if (strcmp(argv[i], "-tokens-check") == 0) //Compare a token file with the input
+            return check_token_file(argv[++i]);
+        else if (strcmp(argv[i], "-chunks") == 0) //Lex with the coroutine lexer, fed this many bytes at a time
+            chunkSize = atoi(argv[++i]);
+    }
+
+    start_stats("Project2", tokenInput == NULL);
+    start_trace();
     Parser parser; //Create parser object
     parser.table = new struct scopeTable(); //Create scope table
+    if (tokenOutput != NULL)
+    {
+        LexicalAnalyzer fileLexer;
+        if (!fileLexer.WriteTokens(tokenOutput))
+        {
+            cerr << "Cannot write token file " << tokenOutput << endl;
+            return 1;
+        }
+        tokenInput = tokenOutput;
+    }
+    if (tokenInput != NULL && !parser.read_tokens(tokenInput))
+    {
+        cerr << "Not a version " << TOKEN_FILE_VERSION << " Project2 token file: " << tokenInput << endl;
+        return 1;
+    }
+    if (tokenInput == NULL && chunkSize > 0)
+        parser.pull_tokens(chunkSize);
+    phaseTimer parse(PHASE_PARSE);
     parser.parse_program(); //Run the parser
     return 0;
 }
\ No newline at end of file
@@ -22,6 +22,8 @@ class Parser
 {
     public:
         void parse_program();
+        bool read_tokens(const char*);
+        void pull_tokens(size_t);
         struct scopeTable *table;
 
     private:
@@ -39,6 +41,8 @@ class Parser
         void parse_statement();
 		std::string find_scope(std::string);
 		void print_parse_statement(std::string, std::string);
+
+        friend struct benchAccess; //The micro benchmarks time find_scope on its own
 };
 
 #endif
\ No newline at end of file
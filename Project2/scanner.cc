@@ -0,0 +1,4 @@
+#include "lexer.h"
+
+//The shared lexer core for Project2's tokens, built optimized so its scanning loops are inlined
+template class LexerCore<projectTokens, StreamSource>;
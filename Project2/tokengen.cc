@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+#include <stdio.h>
+
+#include "tokengen.h"
+#include "../common/stats.h"
+
+using namespace std;
+
+//The shared lexer core over the bytes fed so far
+class chunkScanner : public LexerCore<projectTokens, StringSource> {
+  public:
+    chunkScanner(chunkInput& in) : LexerCore(StringSource(in.text), in.line) { input.SetPutBack(in.putBack); }
+
+    Token Next() { return ScanToken(); } //Not counted, as a token may be lexed again with the next chunk
+    int Read() { return input.Read(); }
+    const std::vector<char>& PutBack() { return input.PutBack(); }
+};
+
+//Lexes like GetToken, one token per co_yield; a token that ran past the fed bytes waits for the next chunk
+static TokenGenerator lex_chunks(chunkInput* in)
+{
+    chunkInput& input = *in;
+
+    while (true)
+    {
+        co_await chunkWait{ input };
+        input.text += input.fed;
+        input.fed.clear();
+
+        chunkScanner scanner(input);
+        while (true)
+        {
+            int read = scanner.Read();
+            input.putBack = scanner.PutBack();
+            Token t = scanner.Next();
+            if (scanner.Reach() >= (int) input.text.size() && !input.Complete()) //Read past text, so go on from before t with more
+            {
+                input.line = scanner.Line(read);
+                input.text.erase(0, read);
+                break;
+            }
+            STAT_COUNT(TOKENS_LEXED);
+            co_yield t;
+        }
+    }
+}
+
+TokenGenerator generate_tokens() //A coroutine lexer waiting for its first chunk
+{
+    return lex_chunks(new chunkInput());
+}
+
+TokenGenerator::~TokenGenerator() //Destroys the coroutine & its input
+{
+    if (handle)
+    {
+        delete handle.promise().input;
+        handle.destroy();
+    }
+}
+
+void TokenGenerator::Feed(const char* bytes, size_t size) //Appends a chunk, which the coroutine lexes once its text runs out
+{
+    handle.promise().input->fed.append(bytes, size);
+}
+
+void TokenGenerator::Finish() //No more chunks, so the end of the fed bytes is the end of the input
+{
+    handle.promise().input->finished = true;
+}
+
+bool TokenGenerator::Next(Token& t) //Runs the lexer to its next token; false while it waits for a chunk
+{
+    promise_type& promise = handle.promise();
+    chunkInput& input = *promise.input;
+    if (input.waiting && input.fed.empty() && !input.finished) //Nothing new to read
+        return false;
+    input.waiting = false;
+    promise.yielded = false;
+    handle.resume();
+    if (!promise.yielded)
+        return false;
+    t = promise.current;
+    return true;
+}
+
+void LexicalAnalyzer::PullTokens(size_t chunkSize) //Lexes with the coroutine lexer from here on, fed chunks of the input of at most a size
+{
+    generator = new TokenGenerator(generate_tokens());
+    chunk.resize(chunkSize);
+}
+
+Token LexicalAnalyzer::PulledToken() //Pulls the next token, reading the next chunk whenever the coroutine lexer waits for one
+{
+    while (!generator->Next(tmp))
+    {
+        phaseTimer reading(PHASE_INPUT);
+        cin.read(chunk.data(), chunk.size());
+        if (cin.gcount() > 0)
+            generator->Feed(chunk.data(), cin.gcount());
+        else
+            generator->Finish();
+    }
+    return tmp;
+}
@@ -0,0 +1,69 @@
+#ifndef __TOKENGEN__H__
+#define __TOKENGEN__H__
+
+#include <coroutine>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+
+// ------- coroutine lexer ---------------
+//The shared lexer core of GetToken driven by a C++20 coroutine, so the input can be fed in chunks as it
+//arrives, e.g. from a socket. The coroutine yields each token once the core has found its end in the
+//bytes fed so far; a token the core read past them for is lexed again, from the core's state before
+//it, once the next chunk comes, so tokens & lines are those of GetToken for any chunk size.
+//Lookahead is left to the caller, which keeps the tokens it has pulled.
+
+//Bytes fed & not lexed into tokens yet
+struct chunkInput {
+    std::string text;      //Bytes the core lexes, from where it had read to after the last token it gave
+    std::vector<char> putBack; //Characters the core had put back there
+    std::string fed;       //Chunks fed since, added to text when a token runs past its end
+    int line = 1;          //Line text starts on
+    bool finished = false; //No chunk comes after fed
+    bool waiting = false;  //The coroutine waits for a chunk
+
+    bool Complete() { return finished && fed.empty(); } //text holds the rest of the input
+};
+
+//Awaited when a token runs past text: goes on at once if a chunk came meanwhile or no more will
+struct chunkWait {
+    chunkInput& input;
+
+    bool await_ready() { return !input.fed.empty() || input.finished; }
+    void await_suspend(std::coroutine_handle<>) { input.waiting = true; }
+    void await_resume() {}
+};
+
+class TokenGenerator {
+  public:
+    struct promise_type {
+        chunkInput* input;
+        Token current;
+        bool yielded = false;
+
+        promise_type(chunkInput* in) : input(in) {}
+        TokenGenerator get_return_object() { return TokenGenerator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const Token& t) { current = t; yielded = true; return {}; }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
+
+    TokenGenerator(TokenGenerator&& other) : handle(other.handle) { other.handle = nullptr; }
+    ~TokenGenerator();
+
+    void Feed(const char*, size_t);
+    void Finish();     //No more chunks, so the end of the fed bytes is the end of the input
+    bool Next(Token&); //False while it waits for a chunk
+
+  private:
+    std::coroutine_handle<promise_type> handle;
+
+    TokenGenerator(std::coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+TokenGenerator generate_tokens(); //A coroutine lexer waiting for its first chunk
+
+#endif  //__TOKENGEN__H__
@@ -0,0 +1,24 @@
+#!/bin/bash
+#Compiles each benchmark to C with -emit-c, checks it prints what -run prints & reports the speedup
+#Run from Project3 after make; CC picks the C compiler
+CC=${CC:-cc}
+for f in bench/*.txt
+do
+    [ $f = bench/sweep.txt ] && continue
+    ./a.out -emit-c < $f > /tmp/aot.c && $CC -O2 -o /tmp/aot /tmp/aot.c || { echo "$f: C build failed"; continue; }
+
+    start=$(date +%s%N)
+    ./a.out -run < $f | grep " = " > /tmp/aot.vm
+    middle=$(date +%s%N)
+    /tmp/aot > /tmp/aot.native
+    end=$(date +%s%N)
+
+    vm=$(( (middle - start) / 1000000 ))
+    native=$(( (end - middle) / 1000000 ))
+    if cmp -s /tmp/aot.vm /tmp/aot.native
+    then
+        echo "$f: vm $vm ms, native $native ms, speedup $(awk "BEGIN { printf \"%.1f\", $vm / ($native > 0 ? $native : 1) }")x"
+    else
+        echo "$f: OUTPUT DIFFERS"
+    fi
+done
@@ -0,0 +1,56 @@
+#!/bin/bash
+#Times ./a.out -edits against checking the whole program again after each edit; run from Project3 after make
+#LINES sets the program size & EDITS the number of one-line edits
+LINES=${LINES:-100000}
+EDITS=${EDITS:-200}
+ulimit -s unlimited #The parser recurses once per statement
+
+#Blocks of 10 lines over declared ints & reals, each with an implicit variable shared by every 500th block
+awk -v lines=$LINES 'BEGIN {
+    for (i = 0; i < 100; i++) print "a" i ": int;"
+    for (i = 0; i < 50; i++) print "r" i ": real;"
+    print "{"
+    for (k = 0; k * 10 < lines; k++)
+    {
+        t = "t" (k % 500); x = "a" (k % 100); y = "a" ((k * 7 + 3) % 100); z = "r" (k % 50)
+        print t " = + " x " " y ";"
+        print x " = * " t " 3;"
+        print "if (> " x " " y ") {"
+        print z " = + " z " 1.5;"
+        print y " = - " y " " t ";"
+        print "}"
+        print "while (< " t " 100) {"
+        print t " = + " t " " x ";"
+        print "}"
+        print y " = " x ";"
+    }
+    print "}"
+}' > /tmp/edits.txt
+
+#Each edit rewrites the last assignment of a random block
+awk -v lines=$LINES -v edits=$EDITS 'BEGIN {
+    srand(340)
+    for (e = 0; e < edits; e++)
+    {
+        k = int(rand() * (lines / 10))
+        line = 151 + k * 10 + 10
+        print line " " line
+        print 1
+        print "a" ((k * 7 + 3) % 100) " = + a" (k % 100) " " e ";"
+    }
+}' > /tmp/edits.script
+
+start=$(date +%s%N)
+./a.out -edits /tmp/edits.script < /tmp/edits.txt > /dev/null 2> /tmp/edits.stats
+end=$(date +%s%N)
+echo "session: $(cat /tmp/edits.stats), total $(( (end - start) / 1000000 )) ms"
+
+#Full checks of the same program, as an editor would run after each edit
+runs=5
+start=$(date +%s%N)
+for i in $(seq $runs)
+do
+    ./a.out -batch < /tmp/edits.txt > /dev/null
+done
+end=$(date +%s%N)
+echo "full check of $LINES lines: $(( (end - start) / 1000000 / runs )) ms each"
@@ -0,0 +1,56 @@
+#!/bin/bash
+#Times parsing expressions with the operator stack & with -recursive; run from Project3 after make
+#DEPTH sets the nesting of the deep expression, ASSIGNS & LEAVES the number & size of the wide ones
+DEPTH=${DEPTH:-300000}
+ASSIGNS=${ASSIGNS:-2000}
+LEAVES=${LEAVES:-2048}
+ulimit -s unlimited #The parser recurses once per statement, & -recursive twice per operator
+
+#One assignment of + 1 + 1 ... 1, nested DEPTH deep
+awk -v depth=$DEPTH 'BEGIN {
+    print "a: int;"
+    print "{"
+    line = "a ="
+    for (i = 0; i < depth; i++) line = line " + 1"
+    print line " 1;"
+    print "}"
+}' > /tmp/expr_deep.txt
+
+#ASSIGNS assignments of a balanced expression over LEAVES operands, a power of two
+awk -v assigns=$ASSIGNS -v leaves=$LEAVES 'function tree(n) {
+        if (n == 1) return "a" (k++ % 8)
+        return "+ " tree(n / 2) " " tree(n / 2)
+    }
+    BEGIN {
+    print "a0, a1, a2, a3, a4, a5, a6, a7: int;"
+    print "{"
+    for (i = 0; i < assigns; i++) print "a" (i % 8) " = " tree(leaves) ";"
+    print "}"
+}' > /tmp/expr_wide.txt
+
+runs=5
+for program in deep wide
+do
+    input=/tmp/expr_$program.txt
+    ./a.out < $input > /tmp/expr.out
+    ./a.out -recursive < $input | cmp -s - /tmp/expr.out || echo "-recursive output differs on $program"
+    for mode in "" "-batch"
+    do
+        for parser in "" "-recursive"
+        do
+            best=0
+            for i in $(seq $runs)
+            do
+                start=$(date +%s%N)
+                ./a.out $mode $parser < $input > /dev/null
+                end=$(date +%s%N)
+                took=$(( (end - start) / 1000000 ))
+                if [ $best == 0 ] || [ $took -lt $best ]
+                then
+                    best=$took
+                fi
+            done
+            echo "$program ${mode:-eager} ${parser:-operator stack}: best $best ms"
+        done
+    done
+done
@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <vector>
+
+#include "../lexer.h"
+#include "../../common/gen.h"
+
+using namespace std;
+
+#define GROUPS 3 //Families of undeclared variables that only meet each other, so their types never clash
+
+//How the operators in expressions are written
+const char* spelling[ERROR + 1];
+
+unsigned long long seed = 1;
+long long outputSize = 1 << 20; //Bytes to write
+int depth = 4;      //Most if, while & case bodies open at once
+int decls = 8;      //Declared variables of each type
+int nest = 12;      //Percent of statements that are if, while or switch
+int reuse = 90;     //Percent of undeclared names already used
+int implicit = 30;  //Percent of assignments to undeclared variables
+int expr = 4;       //Deepest operator nesting in an expression
+int ops = 45;       //Percent of operands that are operators, above the deepest
+int leftOps = 50;   //Percent of operators whose first operand may be an operator too
+int real = 30;      //Percent of int & real expressions that are real
+int literalShare = 30; //Percent of int, real & bool operands that are literals
+int comments = 5;   //Percent of statements with a comment line before them
+
+//Types an expression can be written for
+enum genType { GEN_INT, GEN_REAL, GEN_BOOL, GEN_GROUP };
+
+//An operand still to write: its type, the group when undeclared & its depth
+struct genNeed
+{
+    int type;
+    int group;
+    int level;
+    bool first; //First operand of a binary operator
+};
+
+//A body still open
+struct genBlock
+{
+    bool isCase;
+    long long statements;
+};
+
+const char* prefixes[] = { "i", "r", "b" };
+const char* groupPrefixes[GROUPS] = { "x", "y", "z" };
+long long groupMade[GROUPS];
+
+//Sets the knobs of a preset
+bool preset(const char* name)
+{
+    if (strcmp(name, "deep") == 0) //Bodies nested as deep as they go, around chains of 100 operators on average
+    {
+        depth = 1000000;
+        nest = 100;
+        expr = 1000000;
+        ops = 99;
+        leftOps = 0;
+        return true;
+    }
+    if (strcmp(name, "scan") == 0) //Thousands of declarations, then a new undeclared name in every assignment
+    {
+        decls = 5000;
+        implicit = 90;
+        reuse = 0;
+        return true;
+    }
+    return strcmp(name, "default") == 0;
+}
+
+//Writes spaces for a depth, at most 16
+void put_indent(genOutput& out, int level)
+{
+    out.Put("                                ", 2 * (level < 16 ? level : 16));
+}
+
+//Writes a variable of an undeclared group, new unless reused
+void put_group_var(genOutput& out, genRandom& random, int group)
+{
+    long long& made = groupMade[group];
+    out.Name(groupPrefixes[group], (made > 0 && random.Percent(reuse)) ? random.Below(made) : made++);
+}
+
+//Writes an operand that is not an operator
+void put_primary(genOutput& out, genRandom& random, const genNeed& need)
+{
+    if (need.type == GEN_GROUP)
+        put_group_var(out, random, need.group);
+    else if (decls > 0 && !random.Percent(literalShare))
+        out.Name(prefixes[need.type], random.Below(decls));
+    else if (need.type == GEN_INT)
+        out.Number(random.Below(1000));
+    else if (need.type == GEN_REAL)
+    {
+        out.Number(random.Below(1000));
+        out.Put(".");
+        out.Number(1 + random.Below(99));
+    }
+    else
+        out.Put(random.Percent(50) ? "true" : "false");
+}
+
+//Writes a prefix expression of a type without recursing, so any depth fits
+void put_expression(genOutput& out, genRandom& random, int type, int group)
+{
+    static const int arithmetic[] = { PLUS, MINUS, MULT }; //Not DIV: the lexer takes a lone / for a broken comment
+    static const int relational[] = { GTEQ, GREATER, LTEQ, LESS, EQUAL }; //Not <>, whose type is its operands'
+    vector<genNeed> needs;
+    needs.push_back({ type, group, 0, false });
+    bool firstToken = true;
+
+    while (!needs.empty())
+    {
+        genNeed need = needs.back();
+        needs.pop_back();
+        if (!firstToken)
+            out.Put(" ");
+        firstToken = false;
+
+        bool isOperator = need.level < expr && (!need.first || random.Percent(leftOps)) && random.Percent(ops);
+        if (!isOperator)
+        {
+            put_primary(out, random, need);
+            continue;
+        }
+
+        genNeed operand = { need.type, need.group, need.level + 1, false };
+        if (need.type == GEN_BOOL) //A comparison of ints, reals or a group, or a not
+        {
+            if (random.Percent(25))
+            {
+                out.Put(spelling[NOT]);
+                needs.push_back(operand);
+                continue;
+            }
+            out.Put(spelling[relational[random.Below(5)]]);
+            operand.type = random.Below(3) == 0 ? GEN_GROUP : (random.Percent(real) ? GEN_REAL : GEN_INT);
+            operand.group = random.Below(GROUPS);
+        }
+        else
+            out.Put(spelling[arithmetic[random.Below(3)]]);
+        needs.push_back(operand); //Second operand
+        operand.first = true;
+        needs.push_back(operand);
+    }
+}
+
+//Writes an assignment to a declared or undeclared variable
+void put_assignment(genOutput& out, genRandom& random, int level)
+{
+    put_indent(out, level);
+    if (decls == 0 || random.Percent(implicit))
+    {
+        int group = random.Below(GROUPS);
+        put_group_var(out, random, group);
+        out.Put(" = ");
+        put_expression(out, random, GEN_GROUP, group);
+    }
+    else
+    {
+        int type = random.Percent(20) ? GEN_BOOL : (random.Percent(real) ? GEN_REAL : GEN_INT);
+        out.Name(prefixes[type], random.Below(decls));
+        out.Put(" = ");
+        put_expression(out, random, type, 0);
+    }
+    out.Put(";\n");
+}
+
+//Writes the declarations, then a body of statements until size bytes are out, then closes what is open
+int main(int argc, char* argv[])
+{
+    vector<genKnob> knobs = {
+        { "depth", &depth, "most bodies open at once" },
+        { "decls", &decls, "declared variables of each type" },
+        { "nest", &nest, "percent of statements that are if, while or switch" },
+        { "reuse", &reuse, "percent of undeclared names already used" },
+        { "implicit", &implicit, "percent of assignments to undeclared variables" },
+        { "expr", &expr, "deepest operator nesting in an expression" },
+        { "ops", &ops, "percent of operands that are operators" },
+        { "left", &leftOps, "percent of operators whose first operand may be one" },
+        { "real", &real, "percent of int & real expressions that are real" },
+        { "literals", &literalShare, "percent of operands that are literals" },
+        { "comments", &comments, "percent of statements with a comment before them" },
+    };
+    if (!read_knobs(argc, argv, seed, outputSize, knobs, "default|deep|scan", preset))
+        return 1;
+
+    spelling[NOT] = "!";
+    spelling[PLUS] = "+";
+    spelling[MINUS] = "-";
+    spelling[MULT] = "*";
+    spelling[GTEQ] = ">=";
+    spelling[GREATER] = ">";
+    spelling[LTEQ] = "<=";
+    spelling[LESS] = "<";
+    spelling[EQUAL] = "=";
+
+    genRandom random(seed);
+    genOutput out;
+    static const char* typeNames[] = { "int", "real", "bool" };
+    for (int type = GEN_INT; decls > 0 && type <= GEN_BOOL; type++) //Eight names a line
+    {
+        for (int i = 0; i < decls; i++)
+        {
+            out.Put((i % 8 == 0) ? "" : ", ");
+            out.Name(prefixes[type], i);
+            if (i % 8 == 7 || i + 1 == decls)
+            {
+                out.Put(": ");
+                out.Put(typeNames[type]);
+                out.Put(";\n");
+            }
+        }
+    }
+
+    vector<genBlock> blocks;
+    out.Put("{\n");
+    blocks.push_back({ false, 0 });
+    long long cases = 0;
+    while (out.written < outputSize)
+    {
+        int level = blocks.size();
+        if (random.Percent(comments))
+        {
+            put_indent(out, level);
+            out.Put("// statement ");
+            out.Number(blocks.back().statements);
+            out.Put("\n");
+        }
+        blocks.back().statements++;
+
+        if (level < depth && random.Percent(nest)) //Open an if, while or switch
+        {
+            put_indent(out, level);
+            int kind = random.Below(5);
+            if (kind < 4)
+            {
+                out.Put(kind < 2 ? "if (" : "while (");
+                put_expression(out, random, GEN_BOOL, 0);
+                out.Put(") {\n");
+                blocks.push_back({ false, 0 });
+            }
+            else
+            {
+                out.Put("switch (");
+                put_expression(out, random, GEN_INT, 0);
+                out.Put(") {\n");
+                put_indent(out, level);
+                out.Put("case ");
+                out.Number(cases++ % 10);
+                out.Put(": {\n");
+                blocks.push_back({ true, 0 });
+            }
+            continue;
+        }
+
+        put_assignment(out, random, level);
+        while (level > 1 && random.Percent(15)) //Close the body, then maybe start another case
+        {
+            bool isCase = blocks.back().isCase;
+            blocks.pop_back();
+            put_indent(out, level - 1);
+            if (isCase && random.Percent(50))
+            {
+                out.Put("} case ");
+                out.Number(cases++ % 10);
+                out.Put(": {\n");
+                blocks.push_back({ true, 0 });
+                break;
+            }
+            out.Put(isCase ? "} }\n" : "}\n");
+            level--;
+        }
+    }
+
+    while (!blocks.empty()) //A body needs a statement before it closes
+    {
+        if (blocks.back().statements == 0)
+            put_assignment(out, random, blocks.size());
+        bool isCase = blocks.back().isCase;
+        blocks.pop_back();
+        put_indent(out, blocks.size());
+        out.Put(isCase ? "} }\n" : "}\n");
+    }
+    return 0;
+}
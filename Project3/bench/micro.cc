@@ -0,0 +1,139 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "../lexer.h"
+#include "../parser.h"
+#include "../../common/harness.h"
+
+using namespace std;
+
+#define BENCH_TEXT (1 << 18) //Bytes of input per run
+#define SYMBOLS 500          //Variables in the symbol table
+#define UPDATES 100
+
+//Reaches the scanners GetToken calls, so each is timed on its own
+struct benchAccess
+{
+    static void SkipSpace(LexicalAnalyzer& lexer) { lexer.SkipSpace(); }
+    static Token ScanIdOrKeyword(LexicalAnalyzer& lexer) { return lexer.ScanIdOrKeyword(); }
+    static void GetChar(LexicalAnalyzer& lexer, char& c) { lexer.input.GetChar(c); }
+};
+
+stringbuf source;
+LexicalAnalyzer* benchLexer = NULL;
+
+//Points standard input at a text & starts a new lexer on it
+void lex_text(const string& text)
+{
+    source.str(text);
+    cin.rdbuf(&source);
+    cin.clear();
+    delete benchLexer;
+    benchLexer = new LexicalAnalyzer();
+}
+
+//Fills the symbol table with ints, reals, bools & variables sharing one of 20 unknown types
+void declare_symbols()
+{
+    for (int i = 0; i < SYMBOLS; i++)
+        add_to_list("v" + to_string(i), (i % 5 < 3) ? i % 5 + 1 : 4 + i % 20);
+}
+
+//Driver Code
+int main(int argc, char* argv[])
+{
+    vector<benchCase> cases;
+    string texts[4];
+    InputBuffer<StreamSource>* input = NULL;
+
+    texts[0] = repeat_text("x = + a1 3.5;\n  b2 = x;\n", BENCH_TEXT);
+    cases.push_back({ "InputBuffer::GetChar", (long long) texts[0].size(), (long long) texts[0].size(),
+                      [&] {
+                          lex_text(texts[0]);
+                          delete input;
+                          input = new InputBuffer<StreamSource>();
+                      },
+                      [&] {
+                          char c;
+                          for (size_t i = 0; i < texts[0].size(); i++)
+                              input->GetChar(c);
+                      } });
+
+    texts[1] = repeat_text("  \t\n    x", BENCH_TEXT);
+    long long runs = texts[1].size() / 9;
+    cases.push_back({ "SkipSpace", runs, (long long) texts[1].size(),
+                      [&] { lex_text(texts[1]); },
+                      [runs] {
+                          char c;
+                          for (long long i = 0; i < runs; i++)
+                          {
+                              benchAccess::SkipSpace(*benchLexer);
+                              benchAccess::GetChar(*benchLexer, c); //The x ending each run of spaces
+                          }
+                      } });
+
+    string piece = "alpha while b2 real counter1 ";
+    texts[2] = repeat_text(piece, BENCH_TEXT);
+    long long words = texts[2].size() / piece.size() * count(piece.begin(), piece.end(), ' ');
+    cases.push_back({ "ScanIdOrKeyword", words, (long long) texts[2].size(),
+                      [&] { lex_text(texts[2]); },
+                      [words] {
+                          for (long long i = 0; i < words; i++)
+                          {
+                              benchAccess::ScanIdOrKeyword(*benchLexer);
+                              benchAccess::SkipSpace(*benchLexer);
+                          }
+                      } });
+
+    //Whole tokens, comments & spacing, lexed by GetToken
+    texts[3] = repeat_text("a1 = (b2 + 3.14) * c3;\n  // note\n  if (a1 <= 10) { d4 = !e5; }\n", BENCH_TEXT);
+    long long tokens = 0;
+    lex_text(texts[3]);
+    while (benchLexer->GetToken().token_type != END_OF_FILE)
+        tokens++;
+    cases.push_back({ "GetToken", tokens, (long long) texts[3].size(),
+                      [&] { lex_text(texts[3]); },
+                      [] {
+                          while (benchLexer->GetToken().token_type != END_OF_FILE)
+                              ;
+                      } });
+
+    declare_symbols();
+    vector<string> names;
+    for (int i = 0; i < SYMBOLS; i++)
+        names.push_back("v" + to_string(i));
+
+    //Every name is found, so the table does not grow
+    cases.push_back({ "search_table", SYMBOLS, 0,
+                      [] {},
+                      [&names] {
+                          for (int i = 0; i < SYMBOLS; i++)
+                              search_table(names[i]);
+                      } });
+
+    //Moves the variables of one unknown type to another & back
+    cases.push_back({ "update_type", UPDATES, 0,
+                      [] {},
+                      [] {
+                          for (int i = 0; i < UPDATES; i++)
+                              update_type((i % 2) ? 1000 : 4, (i % 2) ? 4 : 1000);
+                      } });
+
+    stringbuf printed;
+    cases.push_back({ "print_list", SYMBOLS, 0,
+                      [&printed] {
+                          printed.str("");
+                          for (scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+                              iterator->item->printed = false;
+                      },
+                      [&printed] {
+                          streambuf* console = cout.rdbuf(&printed);
+                          print_list();
+                          cout.rdbuf(console);
+                      } });
+
+    return run_benchmarks("Project3", cases, argc, argv);
+}
@@ -0,0 +1,32 @@
+#!/bin/bash
+#Times checking a generated program with the lexer on the parsing thread & on a thread of its own; run from Project3 after make & make gen
+#SIZE sets the program size; the program declares every variable it uses, so the lexer is a large share of the work
+SIZE=${SIZE:-8M}
+ulimit -s unlimited #The parser recurses once per statement
+
+./bench/gen -size $SIZE -seed 5 -implicit 0 > /tmp/pipeline.txt
+bytes=$(stat -c %s /tmp/pipeline.txt)
+echo "program $bytes bytes on $(nproc) cores"
+./a.out < /tmp/pipeline.txt > /tmp/pipeline.out
+./a.out -pipeline < /tmp/pipeline.txt | cmp -s - /tmp/pipeline.out || echo "-pipeline output differs"
+
+runs=5
+for mode in "" "-batch" "-table"
+do
+    for lexing in "" "-pipeline"
+    do
+        best=0
+        for i in $(seq $runs)
+        do
+            start=$(date +%s%N)
+            ./a.out $mode $lexing < /tmp/pipeline.txt > /dev/null
+            end=$(date +%s%N)
+            took=$(( (end - start) / 1000000 ))
+            if [ $best == 0 ] || [ $took -lt $best ]
+            then
+                best=$took
+            fi
+        done
+        echo "check ${mode:-eager} ${lexing:-one thread}: best $best ms, $(( bytes / best )) KB/s"
+    done
+done
@@ -0,0 +1,17 @@
+#!/bin/bash
+#Times ./a.out -run on each benchmark; run from Project3 after make
+for f in bench/*.txt
+do
+    [ $f = bench/sweep.txt ] && continue
+    start=$(date +%s%N)
+    ./a.out -run < $f > /dev/null
+    end=$(date +%s%N)
+    echo "$f: $(( (end - start) / 1000000 )) ms"
+done
+
+#Times ./a.out -columns on a million generated records
+awk 'BEGIN { print "a,b,x,y"; for (i = 0; i < 1000000; i++) printf "%d,%d,%d.%d,%d.5\n", i % 100, i % 7, i % 13, i % 10, i % 5 }' > /tmp/sweep.csv
+start=$(date +%s%N)
+./a.out -columns /tmp/sweep.csv < bench/sweep.txt > /dev/null
+end=$(date +%s%N)
+echo "bench/sweep.txt over 1000000 records: $(( (end - start) / 1000000 )) ms"
@@ -0,0 +1,48 @@
+#!/bin/bash
+#Times checking a program from its text against checking it from a token file; run from Project3 after make
+#LINES sets the program size
+LINES=${LINES:-100000}
+ulimit -s unlimited #The parser recurses once per statement
+
+#Blocks of 10 lines over declared ints & reals, with comments between them
+awk -v lines=$LINES 'BEGIN {
+    for (i = 0; i < 100; i++) print "a" i ": int;"
+    for (i = 0; i < 50; i++) print "r" i ": real;"
+    print "{"
+    for (k = 0; k * 10 < lines; k++)
+    {
+        t = "t" (k % 500); x = "a" (k % 100); y = "a" ((k * 7 + 3) % 100); z = "r" (k % 50)
+        print "// block " k
+        print t " = + " x " " y ";"
+        print x " = * " t " 3;"
+        print "if (> " x " " y ") {"
+        print z " = + " z " 1.5;"
+        print "}"
+        print "while (< " t " 100) {"
+        print t " = + " t " " x ";"
+        print "}"
+        print y " = " x ";"
+    }
+    print "}"
+}' > /tmp/tokens.txt
+
+./a.out -batch -tokens-out /tmp/tokens.tok < /tmp/tokens.txt > /dev/null
+echo "text $(stat -c %s /tmp/tokens.txt) bytes, token file $(stat -c %s /tmp/tokens.tok) bytes"
+./a.out -tokens-check /tmp/tokens.tok < /tmp/tokens.txt
+
+runs=5
+for source in text tokens
+do
+    start=$(date +%s%N)
+    for i in $(seq $runs)
+    do
+        if [ $source == text ]
+        then
+            ./a.out -batch < /tmp/tokens.txt > /dev/null
+        else
+            ./a.out -batch -tokens-in /tmp/tokens.tok < /dev/null > /dev/null
+        fi
+    done
+    end=$(date +%s%N)
+    echo "check from $source: $(( (end - start) / 1000000 / runs )) ms each"
+done
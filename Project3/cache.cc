@@ -0,0 +1,305 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+using namespace std;
+
+const char* cachePath = NULL;
+bool cacheStats = false;
+int checkStatus = 0;
+
+#define CACHE_MAGIC 0x3034334548434143ULL //"CACHE340"
+#define CACHE_VERSION 2
+#ifndef CACHE_SLOTS
+#define CACHE_SLOTS 4096                  //Power of two
+#endif
+#ifndef CACHE_DATA
+#define CACHE_DATA (16 << 20)             //Bytes of keys & results kept at most
+#endif
+
+//Start of the cache file
+struct cacheHeader
+{
+    unsigned long long magic;
+    unsigned int version;
+    unsigned int slots;
+    unsigned long long dataSize;
+    unsigned long long dataEnd;    //Results are appended here
+    unsigned long long clock;      //Ticks once per lookup, for LRU
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long entries;
+    unsigned long long liveBytes;  //Bytes of keys & results still in the table
+};
+
+//One cached result, found by open addressing on its hash; the data area holds its key, then the result
+struct cacheSlot
+{
+    unsigned long long hash;
+    unsigned long long keyLength;
+    unsigned long long offset;     //Into the data area
+    unsigned long long lastUsed;
+    unsigned int length;           //Of the result
+    unsigned int status;           //Exit status of the run
+    unsigned int used;
+    unsigned int pad;
+};
+
+int cacheFile = -1;
+char* cacheMap = NULL;
+size_t cacheBytes;
+cacheHeader* header;
+cacheSlot* slots;
+char* cacheData;
+
+string cacheKey;                   //The input & the options that change the output, compared on a hit so a hash collision is a miss
+unsigned long long keyHash;
+stringbuf inputBuffer;             //Standard input, read once to hash it
+stringbuf capturedOutput;          //What the checker prints on a miss
+streambuf* realOutput;
+
+//*************************************
+//START CACHE FILE
+
+//FNV-1a over some bytes, continuing from h
+unsigned long long fnv1a(unsigned long long h, const char* p, size_t n)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        h ^= (unsigned char) p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+//Maps the cache file, creating or resetting it when it is missing or another version; false when it cannot be used
+bool map_cache()
+{
+    cacheFile = open(cachePath, O_RDWR | O_CREAT, 0644);
+    if(cacheFile < 0)
+        return false;
+    flock(cacheFile, LOCK_EX); //Other runs wait while this one reads or writes
+
+    cacheBytes = sizeof(cacheHeader) + CACHE_SLOTS * sizeof(cacheSlot) + CACHE_DATA;
+    struct stat info;
+    if(fstat(cacheFile, &info) != 0 || ((size_t) info.st_size != cacheBytes && ftruncate(cacheFile, cacheBytes) != 0))
+        return false;
+    cacheMap = (char*) mmap(NULL, cacheBytes, PROT_READ | PROT_WRITE, MAP_SHARED, cacheFile, 0);
+    if(cacheMap == MAP_FAILED)
+        return false;
+
+    header = (cacheHeader*) cacheMap;
+    slots = (cacheSlot*) (cacheMap + sizeof(cacheHeader));
+    cacheData = (char*) (slots + CACHE_SLOTS);
+    if(header->magic != CACHE_MAGIC || header->version != CACHE_VERSION || header->slots != CACHE_SLOTS ||
+       header->dataSize != CACHE_DATA) //New, or written by another format
+    {
+        memset(header, 0, sizeof(cacheHeader));
+        memset(slots, 0, CACHE_SLOTS * sizeof(cacheSlot));
+        header->magic = CACHE_MAGIC;
+        header->version = CACHE_VERSION;
+        header->slots = CACHE_SLOTS;
+        header->dataSize = CACHE_DATA;
+    }
+    return true;
+}
+
+//Unmaps the cache file & lets other runs in
+void unmap_cache()
+{
+    if(cacheMap != NULL && cacheMap != MAP_FAILED)
+        munmap(cacheMap, cacheBytes);
+    if(cacheFile >= 0)
+    {
+        flock(cacheFile, LOCK_UN);
+        close(cacheFile);
+    }
+    cacheMap = NULL;
+    cacheFile = -1;
+}
+
+//Finds the slot of a key, or the empty slot where it would go; a slot matches only when its stored key does
+cacheSlot* find_slot(unsigned long long hash, const string& key)
+{
+    for(unsigned int i = 0, s = hash & (CACHE_SLOTS - 1); i < CACHE_SLOTS; i++, s = (s + 1) & (CACHE_SLOTS - 1))
+    {
+        if(!slots[s].used || (slots[s].hash == hash && slots[s].keyLength == key.size() &&
+                              memcmp(cacheData + slots[s].offset, key.data(), key.size()) == 0))
+            return &slots[s];
+    }
+    return NULL;
+}
+
+//Finds the empty slot a hash goes in, for a table rebuilt from distinct keys
+cacheSlot* free_slot(unsigned long long hash)
+{
+    unsigned int s = hash & (CACHE_SLOTS - 1);
+    while(slots[s].used)
+        s = (s + 1) & (CACHE_SLOTS - 1);
+    return &slots[s];
+}
+
+//Bytes of the data area an entry takes
+unsigned long long entry_bytes(const cacheSlot& slot)
+{
+    return slot.keyLength + slot.length;
+}
+
+//Drops the least recently used results until need more bytes & a slot fit in half the cache,
+//then packs the rest at the front of the data area & rebuilds the table
+void evict(unsigned long long need)
+{
+    vector<cacheSlot> live;
+    for(int s = 0; s < CACHE_SLOTS; s++)
+        if(slots[s].used)
+            live.push_back(slots[s]);
+    sort(live.begin(), live.end(), [](const cacheSlot& x, const cacheSlot& y) { return x.lastUsed > y.lastUsed; });
+
+    unsigned long long kept = 0;
+    size_t count = 0;
+    while(count < live.size() && count + 1 < CACHE_SLOTS / 2 && kept + entry_bytes(live[count]) + need <= CACHE_DATA / 2)
+        kept += entry_bytes(live[count++]);
+    live.resize(count);
+
+    vector<char> packed;
+    packed.reserve(kept);
+    memset(slots, 0, CACHE_SLOTS * sizeof(cacheSlot));
+    for(size_t k = 0; k < live.size(); k++)
+    {
+        cacheSlot entry = live[k];
+        packed.insert(packed.end(), cacheData + entry.offset, cacheData + entry.offset + entry_bytes(entry));
+        entry.offset = packed.size() - entry_bytes(entry);
+        *free_slot(entry.hash) = entry;
+    }
+    if(!packed.empty())
+        memcpy(cacheData, packed.data(), packed.size());
+    header->dataEnd = packed.size();
+    header->entries = live.size();
+    header->liveBytes = kept;
+}
+
+//Appends the key & result of the input, evicting old ones when they do not fit
+void store_result(const string& output, int status)
+{
+    unsigned long long bytes = cacheKey.size() + output.size();
+    if(bytes > CACHE_DATA / 2) //Too big to keep
+        return;
+
+    cacheSlot* slot = find_slot(keyHash, cacheKey);
+    if(slot != NULL && slot->used) //Another run stored it meanwhile
+        return;
+    if(slot == NULL || header->entries + 1 > CACHE_SLOTS * 3 / 4 || header->dataEnd + bytes > CACHE_DATA)
+    {
+        evict(bytes);
+        slot = find_slot(keyHash, cacheKey);
+    }
+
+    memcpy(cacheData + header->dataEnd, cacheKey.data(), cacheKey.size());
+    memcpy(cacheData + header->dataEnd + cacheKey.size(), output.data(), output.size());
+    slot->hash = keyHash;
+    slot->keyLength = cacheKey.size();
+    slot->offset = header->dataEnd;
+    slot->length = output.size();
+    slot->status = status;
+    slot->lastUsed = ++header->clock;
+    slot->used = 1;
+    header->dataEnd += bytes;
+    header->entries++;
+    header->liveBytes += bytes;
+}
+
+//Prints the counters of the cache & how this run went
+void print_cache_stats(const char* outcome)
+{
+    if(!cacheStats)
+        return;
+    cerr << "cache " << outcome << ": hits " << header->hits << ", misses " << header->misses << ", entries "
+         << header->entries << ", bytes " << header->liveBytes << endl;
+}
+
+//*************************************
+//END CACHE FILE
+
+//*************************************
+//START CACHED RUNS
+
+//Runs at exit after a miss, however the checker stopped: prints the captured output & stores it
+void finish_cached_run()
+{
+    string output = capturedOutput.str();
+    cout.rdbuf(realOutput);
+    cout << output;
+    cout.flush();
+
+    if(map_cache())
+    {
+        store_result(output, checkStatus);
+        print_cache_stats("miss");
+    }
+    unmap_cache();
+}
+
+//Looks the input & options up in the cache; a hit prints the stored result & exits,
+//a miss lets the run go on with its output captured for the cache
+void open_result_cache(int argc, char* argv[])
+{
+    ostringstream input;
+    input << cin.rdbuf();
+    string text = input.str();
+
+    cacheKey = to_string(text.size()); //Its length first, so no input & options run together into another's
+    cacheKey += '\0';
+    cacheKey += text;
+    for(int i = 1; i < argc; i++) //Options change the output too, except the cache's own
+    {
+        if(strcmp(argv[i], "-cache") == 0)
+            i++;
+        else if(strcmp(argv[i], "-cache-stats") != 0)
+            cacheKey.append(argv[i], strlen(argv[i]) + 1);
+    }
+    keyHash = fnv1a(1469598103934665603ULL, cacheKey.data(), cacheKey.size());
+
+    inputBuffer.str(text);
+    cin.rdbuf(&inputBuffer);
+    cin.clear();
+
+    if(!map_cache()) //Run without the cache
+    {
+        unmap_cache();
+        return;
+    }
+    cacheSlot* slot = find_slot(keyHash, cacheKey);
+    header->clock++;
+    if(slot != NULL && slot->used) //Hit: no lexing or parsing
+    {
+        header->hits++;
+        slot->lastUsed = header->clock;
+        int status = slot->status;
+        cout.write(cacheData + slot->offset + slot->keyLength, slot->length);
+        cout.flush();
+        print_cache_stats("hit");
+        unmap_cache();
+        exit(status);
+    }
+    header->misses++;
+    unmap_cache();
+
+    realOutput = cout.rdbuf(&capturedOutput);
+    atexit(finish_cached_run);
+}
+
+//*************************************
+//END CACHED RUNS
@@ -0,0 +1,467 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <charconv>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+using namespace std;
+
+const char* columnInput = NULL;
+
+//*************************************
+//START COLUMNS
+
+//Records run together in one block; each variable holds one lane per record
+#define BLOCK 1024
+
+//One block of values; only the array of the column's type is used
+struct column
+{
+    int type;
+    long long i[BLOCK];
+    double r[BLOCK];
+    unsigned char b[BLOCK];
+};
+
+typedef unsigned char laneMask[BLOCK];
+
+vector<column*> varColumns;      //Column of each variable, by index
+vector<column*> tempColumns;     //Scratch columns, reused by every statement
+int tempCount = 0;
+vector<column*> constColumns;    //Column of each constant, by expression
+
+//Claims a scratch column of a type
+column* new_column(int type)
+{
+    if(tempCount == (int) tempColumns.size())
+        tempColumns.push_back(new column());
+    column* result = tempColumns[tempCount++];
+    result->type = type;
+    return result;
+}
+
+//True if any lane is set
+bool any_lane(const laneMask mask)
+{
+    unsigned char any = 0;
+    for(int l = 0; l < BLOCK; l++)
+        any |= mask[l];
+    return any != 0;
+}
+
+//*************************************
+//END COLUMNS
+
+//*************************************
+//START KERNELS
+
+//Converts every lane to another type, with the same rules as the VM
+column* convert_column(column* c, int to)
+{
+    if(c->type == to)
+        return c;
+
+    column* result = new_column(to);
+    if(c->type == 1 && to == 2)
+        for(int l = 0; l < BLOCK; l++) result->r[l] = c->i[l];
+    else if(c->type == 2 && to == 1)
+        for(int l = 0; l < BLOCK; l++) result->i[l] = (long long) c->r[l];
+    else if(c->type == 3 && to == 1)
+        for(int l = 0; l < BLOCK; l++) result->i[l] = c->b[l];
+    else if(c->type == 3 && to == 2)
+        for(int l = 0; l < BLOCK; l++) result->r[l] = c->b[l];
+    else if(c->type == 1) //To bool
+        for(int l = 0; l < BLOCK; l++) result->b[l] = c->i[l] != 0;
+    else
+        for(int l = 0; l < BLOCK; l++) result->b[l] = c->r[l] != 0;
+    return result;
+}
+
+//Integer kernels wrap & divide by zero to 0, like the VM
+void int_kernel(int op, const long long* x, const long long* y, long long* out, unsigned char* cmp)
+{
+    switch (op)
+    {
+        case PLUS: for(int l = 0; l < BLOCK; l++) out[l] = int_add(x[l], y[l]); break;
+        case MINUS: for(int l = 0; l < BLOCK; l++) out[l] = int_sub(x[l], y[l]); break;
+        case MULT: for(int l = 0; l < BLOCK; l++) out[l] = int_mul(x[l], y[l]); break;
+        case DIV: for(int l = 0; l < BLOCK; l++) out[l] = int_div(x[l], y[l]); break;
+        case GREATER: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] > y[l]; break;
+        case GTEQ: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] >= y[l]; break;
+        case LESS: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] < y[l]; break;
+        case LTEQ: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] <= y[l]; break;
+        case EQUAL: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] == y[l]; break;
+        default: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] != y[l]; break;
+    }
+}
+
+void real_kernel(int op, const double* x, const double* y, double* out, unsigned char* cmp)
+{
+    switch (op)
+    {
+        case PLUS: for(int l = 0; l < BLOCK; l++) out[l] = x[l] + y[l]; break;
+        case MINUS: for(int l = 0; l < BLOCK; l++) out[l] = x[l] - y[l]; break;
+        case MULT: for(int l = 0; l < BLOCK; l++) out[l] = x[l] * y[l]; break;
+        case DIV: for(int l = 0; l < BLOCK; l++) out[l] = x[l] / y[l]; break;
+        case GREATER: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] > y[l]; break;
+        case GTEQ: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] >= y[l]; break;
+        case LESS: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] < y[l]; break;
+        case LTEQ: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] <= y[l]; break;
+        case EQUAL: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] == y[l]; break;
+        default: for(int l = 0; l < BLOCK; l++) cmp[l] = x[l] != y[l]; break;
+    }
+}
+
+//Column of a constant, filled on first use & kept for every block
+column* constant_column(int e)
+{
+    if(constColumns.size() < exprNodes.size())
+        constColumns.resize(exprNodes.size(), NULL);
+    if(constColumns[e] != NULL)
+        return constColumns[e];
+
+    exprNode& node = exprNodes[e];
+    column* result = new column();
+    result->type = (node.kind == EXPR_NUM) ? 1 : (node.kind == EXPR_REALNUM) ? 2 : 3;
+    for(int l = 0; l < BLOCK; l++)
+    {
+        result->i[l] = node.num;
+        result->r[l] = node.real;
+        result->b[l] = node.num != 0;
+    }
+    constColumns[e] = result;
+    return result;
+}
+
+//Evaluates an expression for every lane; inactive lanes compute garbage that is never stored
+column* eval_column(int e)
+{
+    exprNode& node = exprNodes[e];
+    column* result;
+
+    switch (node.kind)
+    {
+        case EXPR_VAR:
+            return varColumns[node.var];
+        case EXPR_NUM:
+        case EXPR_BOOL:
+        case EXPR_REALNUM:
+            return constant_column(e);
+        case EXPR_NOT:
+        {
+            column* operand = convert_column(eval_column(node.lhs), 3);
+            result = new_column(3);
+            for(int l = 0; l < BLOCK; l++)
+                result->b[l] = !operand->b[l];
+            return result;
+        }
+    }
+
+    column* LHS = eval_column(node.lhs);
+    column* RHS = eval_column(node.rhs);
+    int operandType = operand_type(node.op, LHS->type, RHS->type);
+    LHS = convert_column(LHS, operandType);
+    RHS = convert_column(RHS, operandType);
+
+    result = new_column(arithmetic_op(node.op) ? operandType : 3);
+    if(operandType == 1)
+        int_kernel(node.op, LHS->i, RHS->i, result->i, result->b);
+    else if(operandType == 2)
+        real_kernel(node.op, LHS->r, RHS->r, result->r, result->b);
+    else if(node.op == EQUAL)
+        for(int l = 0; l < BLOCK; l++) result->b[l] = LHS->b[l] == RHS->b[l];
+    else
+        for(int l = 0; l < BLOCK; l++) result->b[l] = LHS->b[l] != RHS->b[l];
+    return result;
+}
+
+//*************************************
+//END KERNELS
+
+//*************************************
+//START MASKED EXECUTION
+
+//Evaluates a condition into a mask limited to the active lanes
+void eval_condition(int e, const laneMask active, laneMask out)
+{
+    tempCount = 0;
+    column* c = convert_column(eval_column(e), 3);
+    for(int l = 0; l < BLOCK; l++)
+        out[l] = active[l] & c->b[l];
+}
+
+//Copies the active lanes; both sides are always loaded so the loop becomes a vector blend
+template <typename T>
+void masked_store(T* target, const T* value, const laneMask active)
+{
+    for(int l = 0; l < BLOCK; l++)
+    {
+        T kept = target[l];
+        T changed = value[l];
+        target[l] = active[l] ? changed : kept;
+    }
+}
+
+void run_masked_body(vector<int>&, const laneMask);
+
+//Runs one statement on the lanes set in the mask
+void run_masked(int s, const laneMask active)
+{
+    stmtNode& node = stmtNodes[s];
+    laneMask inner;
+
+    switch (node.kind)
+    {
+        case STMT_ASSIGN:
+        {
+            tempCount = 0;
+            column* target = varColumns[node.var];
+            column* value = convert_column(eval_column(node.expr), target->type);
+            if(target->type == 1)
+                masked_store(target->i, value->i, active);
+            else if(target->type == 2)
+                masked_store(target->r, value->r, active);
+            else
+                masked_store(target->b, value->b, active);
+            break;
+        }
+        case STMT_IF:
+            eval_condition(node.expr, active, inner);
+            if(any_lane(inner))
+                run_masked_body(node.body, inner);
+            break;
+        case STMT_WHILE: //Lanes leave the loop one by one
+            for(int l = 0; l < BLOCK; l++)
+                inner[l] = active[l];
+            while(true)
+            {
+                eval_condition(node.expr, inner, inner);
+                if(!any_lane(inner))
+                    break;
+                run_masked_body(node.body, inner);
+            }
+            break;
+        case STMT_SWITCH:
+        {
+            long long value[BLOCK]; //Evaluated once; the cases may change the variables
+            laneMask remaining;
+            tempCount = 0;
+            column* c = convert_column(eval_column(node.expr), 1);
+            for(int l = 0; l < BLOCK; l++)
+            {
+                value[l] = c->i[l];
+                remaining[l] = active[l];
+            }
+
+            for(size_t i = 0; i < node.body.size(); i++) //First matching case wins
+            {
+                stmtNode& option = stmtNodes[node.body[i]];
+                for(int l = 0; l < BLOCK; l++)
+                {
+                    inner[l] = remaining[l] & (value[l] == option.num);
+                    remaining[l] &= !inner[l];
+                }
+                if(any_lane(inner))
+                    run_masked_body(option.body, inner);
+            }
+            break;
+        }
+    }
+}
+
+//Runs a list of statements on the lanes set in the mask
+void run_masked_body(vector<int>& body, const laneMask active)
+{
+    for(size_t i = 0; i < body.size(); i++)
+        run_masked(body[i], active);
+}
+
+//*************************************
+//END MASKED EXECUTION
+
+//*************************************
+//START COLUMN INPUT & OUTPUT
+
+//Reads a whole file into memory
+bool read_file(const char* path, string& data)
+{
+    FILE* file = fopen(path, "rb");
+    if(file == NULL)
+        return false;
+
+    char buffer[1 << 16];
+    size_t count;
+    while((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.append(buffer, count);
+    fclose(file);
+    return true;
+}
+
+//Finds the next field of the line at p, trimmed; p moves past its comma
+void next_field(const char*& p, const char* lineEnd, const char*& first, const char*& last)
+{
+    while(p < lineEnd && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    first = p;
+    while(p < lineEnd && *p != ',')
+        p++;
+    last = p;
+    while(last > first && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r'))
+        last--;
+    if(p < lineEnd) //Skip the comma
+        p++;
+}
+
+//Stores one field into a lane of a column
+void store_field(column* c, int lane, const char* first, const char* last)
+{
+    if(c->type == 2)
+    {
+        if(from_chars(first, last, c->r[lane]).ec != errc()) //Not a plain decimal
+            c->r[lane] = strtod(first, NULL);
+    }
+    else if(c->type == 3)
+        c->b[lane] = (last - first == 4 && strncmp(first, "true", 4) == 0) || (last - first == 1 && *first == '1');
+    else
+        c->i[lane] = strtoll(first, NULL, 10);
+}
+
+//Appends one lane of a column to the output
+void print_field(string& out, column* c, int lane)
+{
+    char buffer[32];
+    if(c->type == 2) //Same digits as %g, much faster
+        out.append(buffer, to_chars(buffer, buffer + sizeof(buffer), c->r[lane], chars_format::general, 6).ptr - buffer);
+    else if(c->type == 3)
+        out += c->b[lane] ? "true" : "false";
+    else //Digits backwards, without printf
+    {
+        unsigned long long value = c->i[lane];
+        if(c->i[lane] < 0)
+            value = 0ULL - value;
+        int at = sizeof(buffer);
+        do
+        {
+            buffer[--at] = '0' + value % 10;
+            value /= 10;
+        } while(value != 0);
+        if(c->i[lane] < 0)
+            buffer[--at] = '-';
+        out.append(buffer + at, sizeof(buffer) - at);
+    }
+}
+
+//Runs the program once per CSV record, BLOCK records at a time, & prints every variable as CSV
+void run_columns()
+{
+    string data;
+    if(!read_file(columnInput, data))
+    {
+        cerr << "Cannot open " << columnInput << endl;
+        exit(1);
+    }
+
+    vector<scopeTableItem*> items; //Symbol table order, for output
+    varColumns.assign(symbolCount, NULL);
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+    {
+        column* c = new column();
+        c->type = run_type(iterator->item);
+        varColumns[iterator->item->index] = c;
+        items.push_back(iterator->item);
+    }
+
+    const char* p = data.c_str();
+    const char* end = p + data.size();
+    const char* lineEnd = (const char*) memchr(p, '\n', end - p);
+    if(lineEnd == NULL)
+        lineEnd = end;
+
+    vector<column*> bound; //Column each CSV field is read into; the header names the variables
+    while(p < lineEnd)
+    {
+        const char* first;
+        const char* last;
+        next_field(p, lineEnd, first, last);
+        string name(first, last);
+        column* c = NULL;
+        for(size_t v = 0; v < items.size(); v++)
+            if(items[v]->name == name)
+                c = varColumns[items[v]->index];
+        if(c == NULL)
+        {
+            cerr << "No variable named " << name << endl;
+            exit(1);
+        }
+        bound.push_back(c);
+    }
+    p = lineEnd + (lineEnd < end);
+
+    string out;
+    for(size_t v = 0; v < items.size(); v++) //Output header
+        out += (v ? "," : "") + items[v]->name;
+    out += "\n";
+
+    laneMask active;
+    while(p < end)
+    {
+        int lanes = 0;
+        for(size_t v = 0; v < items.size(); v++) //Fresh records start at zero
+        {
+            column* c = varColumns[items[v]->index];
+            memset(c->i, 0, sizeof(c->i));
+            memset(c->r, 0, sizeof(c->r));
+            memset(c->b, 0, sizeof(c->b));
+        }
+        while(lanes < BLOCK && p < end)
+        {
+            lineEnd = (const char*) memchr(p, '\n', end - p);
+            if(lineEnd == NULL)
+                lineEnd = end;
+
+            const char* q = p;
+            while(q < lineEnd && (*q == ' ' || *q == '\t' || *q == '\r'))
+                q++;
+            if(q < lineEnd) //Skip blank lines
+            {
+                for(size_t f = 0; f < bound.size() && p < lineEnd; f++)
+                {
+                    const char* first;
+                    const char* last;
+                    next_field(p, lineEnd, first, last);
+                    store_field(bound[f], lanes, first, last);
+                }
+                lanes++;
+            }
+            p = lineEnd + (lineEnd < end);
+        }
+        if(lanes == 0)
+            break;
+
+        for(int l = 0; l < BLOCK; l++)
+            active[l] = l < lanes;
+        run_masked_body(programBody, active);
+
+        for(int l = 0; l < lanes; l++)
+        {
+            for(size_t v = 0; v < items.size(); v++)
+            {
+                if(v)
+                    out += ",";
+                print_field(out, varColumns[items[v]->index], l);
+            }
+            out += "\n";
+        }
+        fwrite(out.data(), 1, out.size(), stdout);
+        out.clear();
+    }
+    fflush(stdout);
+}
+
+//*************************************
+//END COLUMN INPUT & OUTPUT
@@ -0,0 +1,222 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <set>
+#include <stdio.h>
+#include <math.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+using namespace std;
+
+bool emitC = false;
+
+//*************************************
+//START C EXPRESSIONS
+
+string cTypes[] = { "", "long long", "double", "unsigned char" };
+string typeNames[] = { "", "int", "real", "bool" };
+vector<string> cNames;          //C name of each variable, by index
+vector<int> cVarTypes;          //Runtime type of each variable, by index
+
+//Converts a C expression between types, with the same rules as the VM
+string convert_c(string expr, int from, int to)
+{
+    if(from == to)
+        return expr;
+    if(to == 3) //Anything nonzero is true
+        return "(" + expr + " != 0)";
+    return "((" + cTypes[to] + ") " + expr + ")";
+}
+
+//Writes a constant so C reads back the same value
+string constant_c(exprNode& node)
+{
+    char buffer[64];
+    if(node.kind == EXPR_REALNUM && isinf(node.real)) //Too many digits, or folded
+        snprintf(buffer, sizeof(buffer), node.real > 0 ? "(1e308 * 10.0)" : "(-1e308 * 10.0)");
+    else if(node.kind == EXPR_REALNUM && isnan(node.real)) //Folded
+        snprintf(buffer, sizeof(buffer), "(0.0 / 0.0)");
+    else if(node.kind == EXPR_REALNUM)
+        snprintf(buffer, sizeof(buffer), "%.17g", node.real);
+    else if(node.num == (-9223372036854775807LL - 1)) //No literal for the smallest int
+        snprintf(buffer, sizeof(buffer), "(-9223372036854775807LL - 1)");
+    else
+        snprintf(buffer, sizeof(buffer), "%lldLL", node.num);
+    string text = buffer;
+    if(node.kind == EXPR_REALNUM && text.find_first_of(".e(") == string::npos) //Keep it a double
+        text += ".0";
+    return text;
+}
+
+//Emits an expression as C, setting its type
+string emit_expression(int e, int& type)
+{
+    exprNode& node = exprNodes[e];
+    int lhsType, rhsType;
+
+    switch (node.kind)
+    {
+        case EXPR_VAR:
+            type = cVarTypes[node.var];
+            return cNames[node.var];
+        case EXPR_NUM:
+            type = 1;
+            return constant_c(node);
+        case EXPR_REALNUM:
+            type = 2;
+            return constant_c(node);
+        case EXPR_BOOL:
+            type = 3;
+            return node.num ? "1" : "0";
+        case EXPR_NOT:
+        {
+            string operand = emit_expression(node.lhs, lhsType);
+            type = 3;
+            return "(!" + convert_c(operand, lhsType, 3) + ")";
+        }
+    }
+
+    string LHS = emit_expression(node.lhs, lhsType);
+    string RHS = emit_expression(node.rhs, rhsType);
+    int operandType = operand_type(node.op, lhsType, rhsType);
+    LHS = convert_c(LHS, lhsType, operandType);
+    RHS = convert_c(RHS, rhsType, operandType);
+    type = arithmetic_op(node.op) ? operandType : 3;
+
+    if(type == 1) //Wrapping helpers from the prelude
+    {
+        string helper = (node.op == PLUS) ? "iadd" : (node.op == MINUS) ? "isub" : (node.op == MULT) ? "imul" : "idiv";
+        return helper + "(" + LHS + ", " + RHS + ")";
+    }
+
+    string op;
+    switch (node.op)
+    {
+        case PLUS: op = "+"; break;
+        case MINUS: op = "-"; break;
+        case MULT: op = "*"; break;
+        case DIV: op = "/"; break;
+        case GREATER: op = ">"; break;
+        case GTEQ: op = ">="; break;
+        case LESS: op = "<"; break;
+        case LTEQ: op = "<="; break;
+        case EQUAL: op = "=="; break;
+        default: op = "!="; break;
+    }
+    return "(" + LHS + " " + op + " " + RHS + ")";
+}
+
+//Emits an expression converted to a type
+string emit_as(int e, int type)
+{
+    int exprType;
+    string expr = emit_expression(e, exprType);
+    return convert_c(expr, exprType, type);
+}
+
+//*************************************
+//END C EXPRESSIONS
+
+//*************************************
+//START C STATEMENTS
+
+void emit_body(vector<int>&, int);
+
+//Emits one statement at an indent
+void emit_statement(int s, int indent)
+{
+    stmtNode& node = stmtNodes[s];
+    string pad(indent * 4, ' ');
+
+    switch (node.kind)
+    {
+        case STMT_ASSIGN:
+            cout << pad << cNames[node.var] << " = " << emit_as(node.expr, cVarTypes[node.var]) << ";\n";
+            break;
+        case STMT_IF:
+            cout << pad << "if (" << emit_as(node.expr, 3) << ")\n" << pad << "{\n";
+            emit_body(node.body, indent + 1);
+            cout << pad << "}\n";
+            break;
+        case STMT_WHILE:
+            cout << pad << "while (" << emit_as(node.expr, 3) << ")\n" << pad << "{\n";
+            emit_body(node.body, indent + 1);
+            cout << pad << "}\n";
+            break;
+        case STMT_SWITCH:
+        {
+            set<long long> labels; //A repeated label can never be reached
+            cout << pad << "switch (" << emit_as(node.expr, 1) << ")\n" << pad << "{\n";
+            for(size_t i = 0; i < node.body.size(); i++)
+            {
+                stmtNode& option = stmtNodes[node.body[i]];
+                if(!labels.insert(option.num).second)
+                    continue;
+                exprNode label = exprNode();
+                label.kind = EXPR_NUM;
+                label.num = option.num;
+                cout << pad << "    case " << constant_c(label) << ":\n" << pad << "    {\n";
+                emit_body(option.body, indent + 2);
+                cout << pad << "    }\n" << pad << "    break;\n";
+            }
+            cout << pad << "}\n";
+            break;
+        }
+    }
+}
+
+//Emits a list of statements
+void emit_body(vector<int>& body, int indent)
+{
+    for(size_t i = 0; i < body.size(); i++)
+        emit_statement(body[i], indent);
+}
+
+//Prints a C translation unit that runs the program & prints every variable like -run
+void emit_c_program()
+{
+    vector<scopeTableItem*> items;
+    cNames.assign(symbolCount, "");
+    cVarTypes.assign(symbolCount, 1);
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+    {
+        scopeTableItem* item = iterator->item;
+        cNames[item->index] = "v_" + item->name; //Never a C keyword
+        cVarTypes[item->index] = run_type(item);
+        items.push_back(item);
+    }
+
+    cout << "/* Generated from a Project3 program; inferred types:\n";
+    for(size_t v = 0; v < items.size(); v++)
+        cout << " *   " << items[v]->name << ": " << (items[v]->type > 3 ? "? (int)" : typeNames[items[v]->type]) << "\n";
+    cout << " */\n";
+    cout << "#include <stdio.h>\n\n";
+    cout << "/* Integer arithmetic wraps & dividing by zero gives 0, like the VM */\n";
+    cout << "static long long iadd(long long a, long long b) { return (long long) ((unsigned long long) a + (unsigned long long) b); }\n";
+    cout << "static long long isub(long long a, long long b) { return (long long) ((unsigned long long) a - (unsigned long long) b); }\n";
+    cout << "static long long imul(long long a, long long b) { return (long long) ((unsigned long long) a * (unsigned long long) b); }\n";
+    cout << "static long long idiv(long long a, long long b) { return b == 0 ? 0 : b == -1 ? (long long) (0ULL - (unsigned long long) a) : a / b; }\n\n";
+
+    for(size_t v = 0; v < items.size(); v++)
+        cout << "static " << cTypes[cVarTypes[items[v]->index]] << " " << cNames[items[v]->index] << ";\n";
+
+    cout << "\nint main(void)\n{\n";
+    emit_body(programBody, 1);
+    for(size_t v = 0; v < items.size(); v++)
+    {
+        int index = items[v]->index;
+        cout << "    printf(\"" << items[v]->name << " = ";
+        if(cVarTypes[index] == 2)
+            cout << "%g\\n\", " << cNames[index] << ");\n";
+        else if(cVarTypes[index] == 3)
+            cout << "%s\\n\", " << cNames[index] << " ? \"true\" : \"false\");\n";
+        else
+            cout << "%lld\\n\", " << cNames[index] << ");\n";
+    }
+    cout << "    return 0;\n}\n";
+}
+
+//*************************************
+//END C STATEMENTS
@@ -0,0 +1,593 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <stdlib.h>
+
+#include "lexer.h"
+#include "parser.h"
+#include "../common/stats.h"
+
+using namespace std;
+
+bool batchInference = false;
+bool parallelInference = false;
+int inferenceThreads = 0;
+vector<typeConstraint> constraints;
+vector<int> statementStarts;
+
+//*************************************
+//START TYPING RULES
+
+//Replaces type current with newType, in the solver or in the list of variables
+void retype(int current, int newType, typeSolver* solver);
+
+//Applies rule C2 to a binary operator & returns the mismatch code or 0
+int check_binary(int op, int LHS, int RHS, int& type, typeSolver* solver)
+{
+    type = op;
+    if(LHS != RHS)
+    {
+        if(op == PLUS || op == MINUS || op == MULT || op == DIV) //Check which operator type
+        {
+            if(LHS <= 2 && RHS > 3)
+            {
+                retype(RHS, LHS, solver);
+                RHS = LHS;
+            }
+            else if(LHS > 3 && RHS <= 2)
+            {
+                retype(RHS, LHS, solver);
+                LHS = RHS;
+            }
+            else if(LHS > 3 && RHS > 3)
+            {
+                retype(RHS, LHS, solver);
+                RHS = LHS;
+            }
+            else //Else a type mismatch
+                return 2;
+        }
+        else if(op == GTEQ || op == GREATER || op == LTEQ || op == LESS || op == NOTEQUAL || op == EQUAL) //Check which operator type
+        {
+            if(RHS > 3 && LHS > 3)
+            {
+                retype(RHS, LHS, solver);
+                type = 3;
+                return 0;
+            }
+            else //Else a type mismatch
+                return 2;
+        }
+        else //Else a type mismatch
+            return 2;
+    }
+
+    if(op == GTEQ || op == GREATER || op == LTEQ || op == LESS || op == EQUAL) //Check for excluding NOTEQUAL
+        type = 3;
+    else
+        type = RHS;
+    return 0;
+}
+
+//Applies rule C3 to the operand of NOT & returns the mismatch code or 0
+int check_not(int type)
+{
+    if(type != 3)
+        return 3;
+    return 0;
+}
+
+//Applies rule C1 to an assignment & returns the mismatch code or 0
+int check_assignment(int LHS, int RHS, typeSolver* solver)
+{
+    if(LHS == 1 || LHS == 2 || LHS == 3) //Check for INT, REAL, BOOL
+    {
+        if(LHS != RHS)
+        {
+            if(LHS > 2) //Check for LHS - RHS compatible
+                retype(RHS, LHS, solver);
+            else //Else a mismatch
+                return 1;
+        }
+    }
+    else //Compatible
+        retype(LHS, RHS, solver);
+    return 0;
+}
+
+//Applies rule C4 (if, while) or C5 (switch) to a condition & returns the mismatch code or 0
+int check_condition(int type, int code)
+{
+    if(code == 4 && type != 3) //Check for matching BOOL
+        return 4;
+    if(code == 5 && type <= 3 && type != 1) //Check for matching INT
+        return 5;
+    return 0;
+}
+
+//*************************************
+//END TYPING RULES
+
+//*************************************
+//START SOLVER
+
+//Union-find over variables, each class carrying the type shared by its members
+struct typeSolver
+{
+    vector<int> varNode;   //Variable index -> node
+    vector<int> varLine;   //Variable index -> declaration line
+    vector<int> parent;    //Node -> parent node
+    vector<int> size;      //Root -> class size
+    vector<int> label;     //Root -> type of the class
+    unordered_map<int, int> labelRoot; //Type -> root of its class
+    vector<int> slots;     //Constraint index -> type of the slot it defines
+    bool global;           //Set once a type shared by all statements (int, real, bool) was replaced
+
+    int find(int);
+    int make_node(int);
+    int type_of(int);
+    void update(int, int);
+    void declare(int, int);
+};
+
+//Finds the root of a node, halving the path on the way
+int typeSolver::find(int node)
+{
+    while(parent[node] != node)
+    {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+//Creates a node of the given type, joining the class that has the type already
+int typeSolver::make_node(int type)
+{
+    int node = parent.size();
+    parent.push_back(node);
+    size.push_back(1);
+    label.push_back(type);
+
+    unordered_map<int, int>::iterator found = labelRoot.find(type);
+    if(found == labelRoot.end()) //First node of this type
+        labelRoot[type] = node;
+    else //Join the existing class
+    {
+        parent[node] = found->second;
+        size[found->second]++;
+    }
+    return node;
+}
+
+//Returns the current type of a variable
+int typeSolver::type_of(int var)
+{
+    return label[find(varNode[var])];
+}
+
+//Same effect as update_type: every variable of type current now has newType
+void typeSolver::update(int current, int newType)
+{
+    if(current == newType)
+        return;
+
+    if(current <= 3) //Retypes variables of every statement
+        global = true;
+
+    unordered_map<int, int>::iterator from = labelRoot.find(current);
+    if(from == labelRoot.end()) //No variable has this type
+        return;
+
+    int root = from->second;
+    labelRoot.erase(from);
+
+    unordered_map<int, int>::iterator to = labelRoot.find(newType);
+    if(to != labelRoot.end()) //Merge the smaller class into the larger
+    {
+        int other = to->second;
+        if(size[root] < size[other])
+            swap(root, other);
+        parent[other] = root;
+        size[root] += size[other];
+    }
+    label[root] = newType;
+    labelRoot[newType] = root;
+}
+
+//Moves one variable out of its class & gives it a declared type
+void typeSolver::declare(int var, int type)
+{
+    varNode[var] = make_node(type);
+}
+
+//Replaces type current with newType, in the solver or in the list of variables
+void retype(int current, int newType, typeSolver* solver)
+{
+    if(solver == NULL)
+        update_type(current, newType);
+    else
+        solver->update(current, newType);
+}
+
+//Marks the start of the constraints of a statement, condition or declaration
+void begin_statement()
+{
+    if(batchInference)
+        statementStarts.push_back(constraints.size());
+}
+
+//Records a constraint at the current token & returns the slot it defines
+int emit_constraint(int kind, int lhs, int rhs, int op)
+{
+    typeConstraint c;
+    c.kind = kind;
+    c.lhs = lhs;
+    c.rhs = rhs;
+    c.op = op;
+    c.line_no = token.line_no;
+    constraints.push_back(c);
+    return constraints.size() - 1;
+}
+
+//Loads every variable in the list with the type it was created with
+void init_solver(typeSolver& solver)
+{
+    solver.varNode.clear();
+    solver.varLine.clear();
+    solver.slots.assign(constraints.size(), 0);
+    solver.global = false;
+
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+    {
+        solver.varNode.push_back(solver.make_node(iterator->item->type));
+        solver.varLine.push_back(iterator->item->line_no);
+    }
+}
+
+//Applies one constraint of a list & returns the mismatch code or 0
+int apply_constraint(typeSolver& solver, const typeConstraint* list, int index)
+{
+    const typeConstraint& c = list[index];
+    vector<int>& slots = solver.slots;
+
+    switch (c.kind)
+    {
+        case LOAD_VAR:
+            slots[index] = solver.type_of(c.lhs);
+            return 0;
+        case LOAD_CONST:
+            slots[index] = c.lhs;
+            return 0;
+        case BINARY_OP:
+            return check_binary(c.op, slots[c.lhs], slots[c.rhs], slots[index], &solver);
+        case UNARY_NOT:
+            slots[index] = slots[c.lhs];
+            return check_not(slots[c.lhs]);
+        case ASSIGN:
+            return check_assignment(slots[c.lhs], slots[c.rhs], &solver);
+        case CONDITION:
+            return check_condition(slots[c.lhs], c.op);
+        case DECLARE:
+        {
+            //Variables are added in line order, so those on this line are contiguous
+            vector<int>::iterator first = solver.varLine.begin();
+            vector<int>::iterator last = first + c.lhs;
+            vector<int>::iterator low = lower_bound(first, last, c.line_no);
+            vector<int>::iterator high = upper_bound(low, last, c.line_no);
+            for(vector<int>::iterator it = low; it != high; it++)
+                solver.declare(it - first, c.op);
+            return 0;
+        }
+    }
+    return 0;
+}
+
+//Solves the recorded constraints in order & stores the types in the list of variables
+void solve_constraints()
+{
+    phaseTimer unify(PHASE_UNIFY);
+    typeSolver solver;
+    init_solver(solver);
+
+    for(int i = 0; i < (int) constraints.size(); i++)
+    {
+        int code = apply_constraint(solver, constraints.data(), i);
+        if(code != 0) //Report the first mismatch as the parser would have
+            type_mismatch(constraints[i].line_no, code);
+    }
+
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+        iterator->item->type = solver.type_of(iterator->item->index);
+}
+
+//Solves units of an edit session in order over some variables, each starting at its type after the declarations;
+//stores their types & returns the index of the first unit with a mismatch, or -1
+int solve_units(vector<editUnit*>& units, const vector<int>& vars, const vector<int>& startType, vector<scopeTableItem*>& items)
+{
+    typeSolver solver;
+    solver.varNode.assign(symbolCount, -1); //Units only load variables from the list
+    for(size_t v = 0; v < vars.size(); v++)
+        solver.varNode[vars[v]] = solver.make_node(startType[vars[v]]);
+
+    for(size_t u = 0; u < units.size(); u++)
+    {
+        editUnit* unit = units[u];
+        if(solver.slots.size() < unit->constraints.size())
+            solver.slots.resize(unit->constraints.size());
+        solver.global = false;
+        unit->mismatchCode = 0;
+        for(int i = 0; i < (int) unit->constraints.size(); i++)
+        {
+            int code = apply_constraint(solver, unit->constraints.data(), i);
+            if(code != 0) //Stop where the parser would have
+            {
+                unit->mismatchCode = code;
+                unit->mismatchAt = i;
+                break;
+            }
+        }
+        unit->global = solver.global;
+        if(unit->mismatchCode != 0)
+            return u;
+    }
+
+    for(size_t v = 0; v < vars.size(); v++)
+        items[vars[v]]->type = solver.type_of(vars[v]);
+    return -1;
+}
+
+//*************************************
+//END SOLVER
+
+//*************************************
+//START PARALLEL SOLVER
+
+//Statements below this many per thread are solved sequentially
+#define MIN_STATEMENTS_PER_THREAD 1024
+
+//Finds the root of a variable in a union-find shared between threads
+int shared_find(vector<atomic<int> >& parent, int var)
+{
+    int next = parent[var].load(memory_order_relaxed);
+    while(next != var)
+    {
+        var = next;
+        next = parent[var].load(memory_order_relaxed);
+    }
+    return var;
+}
+
+//Joins two variables, always linking the larger root below the smaller one
+void shared_union(vector<atomic<int> >& parent, int a, int b)
+{
+    while(true)
+    {
+        a = shared_find(parent, a);
+        b = shared_find(parent, b);
+        if(a == b)
+            return;
+        if(a < b)
+            swap(a, b);
+        int expected = a;
+        if(parent[a].compare_exchange_weak(expected, b))
+            return;
+    }
+}
+
+//Finds the root of a variable in a thread-local union-find
+int local_find(vector<int>& parent, int var)
+{
+    while(parent[var] != var)
+    {
+        parent[var] = parent[parent[var]];
+        var = parent[var];
+    }
+    return var;
+}
+
+//Calls visit for every variable the constraints of a statement touch
+template <typename Visit>
+void statement_vars(int unit, const vector<int>& varLine, Visit visit)
+{
+    int end = (unit + 1 < (int) statementStarts.size()) ? statementStarts[unit + 1] : constraints.size();
+    for(int i = statementStarts[unit]; i < end; i++)
+    {
+        const typeConstraint& c = constraints[i];
+        if(c.kind == LOAD_VAR)
+            visit(c.lhs);
+        else if(c.kind == DECLARE) //Every variable declared on the line
+        {
+            vector<int>::const_iterator first = varLine.begin();
+            vector<int>::const_iterator low = lower_bound(first, first + c.lhs, c.line_no);
+            vector<int>::const_iterator high = upper_bound(low, first + c.lhs, c.line_no);
+            for(vector<int>::const_iterator it = low; it != high; it++)
+                visit(it - first);
+        }
+    }
+}
+
+//Result of solving the statements given to one thread
+struct partitionResult
+{
+    int mismatchAt;   //Constraint index of the first mismatch, or -1
+    int code;         //Its mismatch code
+    int globalAt;     //Constraint index of the first update to int, real or bool, or -1
+};
+
+//Solves components of independent statements on several threads, falling back to
+//solve_constraints when one statement retypes every int, real or bool variable
+void solve_constraints_parallel()
+{
+    phaseTimer unify(PHASE_UNIFY);
+    int units = statementStarts.size();
+    int threads = inferenceThreads;
+    if(threads <= 0) //Default to the machine, but keep enough work per thread
+        threads = min((int) thread::hardware_concurrency(), units / MIN_STATEMENTS_PER_THREAD);
+    threads = min(threads, units);
+    if(threads <= 1)
+    {
+        solve_constraints();
+        return;
+    }
+
+    vector<int> varLine;
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+        varLine.push_back(iterator->item->line_no);
+    int vars = varLine.size();
+
+    //Each thread joins the variables of its own statements, then merges into the shared forest
+    vector<atomic<int> > shared(vars);
+    for(int v = 0; v < vars; v++)
+        shared[v].store(v, memory_order_relaxed);
+    vector<int> unitVar(units, -1);
+    vector<thread> pool;
+
+    for(int t = 0; t < threads; t++)
+    {
+        pool.push_back(thread([&, t]() {
+            int first = (long long) units * t / threads;
+            int last = (long long) units * (t + 1) / threads;
+            vector<int> parent(vars);
+            vector<int> touched;
+            for(int v = 0; v < vars; v++)
+                parent[v] = v;
+
+            for(int u = first; u < last; u++)
+            {
+                statement_vars(u, varLine, [&](int v) {
+                    if(unitVar[u] < 0)
+                        unitVar[u] = v;
+                    int a = local_find(parent, unitVar[u]);
+                    int b = local_find(parent, v);
+                    if(a != b)
+                        parent[max(a, b)] = min(a, b);
+                    touched.push_back(v);
+                });
+            }
+            for(int i = 0; i < (int) touched.size(); i++)
+                shared_union(shared, touched[i], local_find(parent, touched[i]));
+        }));
+    }
+    for(int t = 0; t < threads; t++)
+        pool[t].join();
+    pool.clear();
+
+    //Group the statements of each component, keeping program order
+    vector<int> rootComponent(vars, -1);
+    vector<vector<int> > components;
+    for(int u = 0; u < units; u++)
+    {
+        int component;
+        if(unitVar[u] < 0) //Touches no variable
+            component = -1;
+        else
+            component = rootComponent[shared_find(shared, unitVar[u])];
+
+        if(component < 0)
+        {
+            component = components.size();
+            components.push_back(vector<int>());
+            if(unitVar[u] >= 0)
+                rootComponent[shared_find(shared, unitVar[u])] = component;
+        }
+        components[component].push_back(u);
+    }
+
+    //Solve whole components on each thread, largest first onto the least loaded thread
+    vector<int> order(components.size());
+    for(int i = 0; i < (int) order.size(); i++)
+        order[i] = i;
+    sort(order.begin(), order.end(), [&](int a, int b) { return components[a].size() > components[b].size(); });
+
+    vector<vector<int> > assigned(threads);
+    vector<long long> load(threads, 0);
+    vector<int> componentThread(components.size());
+    for(int i = 0; i < (int) order.size(); i++)
+    {
+        int t = min_element(load.begin(), load.end()) - load.begin();
+        assigned[t].push_back(order[i]);
+        load[t] += components[order[i]].size();
+        componentThread[order[i]] = t;
+    }
+
+    vector<typeSolver> solvers(threads);
+    vector<partitionResult> results(threads);
+    for(int t = 0; t < threads; t++)
+    {
+        pool.push_back(thread([&, t]() {
+            typeSolver& solver = solvers[t];
+            partitionResult& result = results[t];
+            result.mismatchAt = result.globalAt = -1;
+            result.code = 0;
+            init_solver(solver);
+
+            for(int k = 0; k < (int) assigned[t].size(); k++)
+            {
+                const vector<int>& members = components[assigned[t][k]];
+                bool stopped = false;
+                for(int m = 0; m < (int) members.size() && !stopped; m++)
+                {
+                    int u = members[m];
+                    int end = (u + 1 < units) ? statementStarts[u + 1] : constraints.size();
+                    for(int i = statementStarts[u]; i < end; i++)
+                    {
+                        int code = apply_constraint(solver, constraints.data(), i);
+                        if(solver.global && (result.globalAt < 0 || i < result.globalAt))
+                            result.globalAt = i;
+                        solver.global = false;
+                        if(code != 0) //This component stops at its first mismatch
+                        {
+                            if(result.mismatchAt < 0 || i < result.mismatchAt)
+                            {
+                                result.mismatchAt = i;
+                                result.code = code;
+                            }
+                            stopped = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }));
+    }
+    for(int t = 0; t < threads; t++)
+        pool[t].join();
+
+    //The first mismatch in program order, unless a global update came before it
+    int mismatchAt = -1, code = 0, globalAt = -1;
+    for(int t = 0; t < threads; t++)
+    {
+        if(results[t].mismatchAt >= 0 && (mismatchAt < 0 || results[t].mismatchAt < mismatchAt))
+        {
+            mismatchAt = results[t].mismatchAt;
+            code = results[t].code;
+        }
+        if(results[t].globalAt >= 0 && (globalAt < 0 || results[t].globalAt < globalAt))
+            globalAt = results[t].globalAt;
+    }
+
+    if(globalAt >= 0 && (mismatchAt < 0 || globalAt < mismatchAt))
+    {
+        solve_constraints();
+        return;
+    }
+    if(mismatchAt >= 0)
+        type_mismatch(constraints[mismatchAt].line_no, code);
+
+    //Each variable takes its type from the thread that solved its component
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+    {
+        int var = iterator->item->index;
+        int component = rootComponent[shared_find(shared, var)];
+        int t = (component < 0) ? 0 : componentThread[component];
+        iterator->item->type = solvers[t].type_of(var);
+    }
+}
+
+//*************************************
+//END PARALLEL SOLVER
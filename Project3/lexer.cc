@@ -4,65 +4,17 @@
 #include <string>
 #include <cctype>
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <algorithm>
 
 #include "lexer.h"
-#include "inputbuf.h"
+#include "parser.h"
+#include "../common/stats.h"
+#include "../common/trace.h"
 
 using namespace std;
 
-//Forward Declarations
-void parse_program();
-void print_list();
-void parse_var_list();
-void parse_unary_operator();
-void update_type(int, int);
-void parse_assignment_stmt();
-void parse_case();
-void parse_case_list();
-void parse_switch_stmt();
-void parse_while_stmt();
-void parse_if_stmt();
-void parse_stmt();
-void parse_stmt_list();
-void parse_body();
-void parse_type_name();
-void parse_var_decl();
-void parse_var_decl_list();
-void parse_global_vars();
-		
-bool is_binary_operator(int);
-bool is_expression(int);
-		
-int parse_primary();
-int parse_expression();
-int parse_binary_operator();
-		
-//Mismatch Handling
-void type_mismatch(int, int);
-void syntax_error();
-		
-//List Functions
-void add_to_list(std::string, int);
-int search_table(std::string);
-
-//For each individual variable
-struct scopeTableItem
-{
-    std::string name;
-    int line_no;
-    int type;
-    bool printed;
-};
-
-struct scopeTable
-{
-    scopeTableItem* item;
-    scopeTable *next;
-    scopeTable *prev;
-};
-
 scopeTable* symbolTable;
 
 string reserved[] = { "END_OF_FILE", "INT", "REAL", "BOOL", "TR", "FA", "IF", "WHILE", "SWITCH", "CASE", "PUBLIC", 
@@ -76,8 +28,6 @@ string reserved[] = { "END_OF_FILE", "INT", "REAL", "BOOL", "TR", "FA", "IF", "W
 //22 = NOTEQUAL, 23 = LESS, 24 = LPAREN, 25 = RPAREN, 26 = EQUAL, 27 = COLON, 28 = COMMA, 29 = SEMICOLON, 30 = LBRACE, 31 = RBRACE
 //32 = ID, 33 = ERROR
 
-#define KEYWORDS_COUNT 11
-string keyword[] = {"int", "real", "bool", "true", "false", "if", "while", "switch", "case", "public", "private"};
 
 //*************************************
 //START LEXER
@@ -85,6 +35,9 @@ string keyword[] = {"int", "real", "bool", "true", "false", "if", "while", "swit
 LexicalAnalyzer lexer;
 Token token;
 int enumCount = 4;
+int symbolCount = 0;
+bool recursiveExpressions = false;
+bool tableParser = false;
 
 //Formatted Print
 void Token::Print()
@@ -94,291 +47,42 @@ void Token::Print()
         << this->line_no << "}\n";
 }
 
-//Constructor
+//Constructor; the core starts on line 1
 LexicalAnalyzer::LexicalAnalyzer()
 {
-    this->line_no = 1;
-    tmp.lexeme = "";
-    tmp.line_no = 1;
-    tmp.token_type = ERROR;
-}
-
-//Skips spaces in the program
-void LexicalAnalyzer::SkipSpace()
-{
-    char c;
-
-    input.GetChar(c);
-    line_no += (c == '\n');
-
-    while (!input.EndOfInput() && isspace(c))
-    {
-        input.GetChar(c);
-        line_no += (c == '\n');
-    }
-
-    if (!input.EndOfInput())
-        input.UngetChar(c);
-}
-
-//Skips comments in the program
-void LexicalAnalyzer::SkipComments()
-{
-    char c;
-	
-    if(input.EndOfInput()) //Check for EOF
-        input.UngetChar(c);
-	else
-	{
-		input.GetChar(c);
-		if(c == '/') //Check for first /
-		{
-			input.GetChar(c);
-			if(c == '/') //Check for second /
-			{
-				while(c != '\n') //Go through comment
-				{
-					input.GetChar(c);
-				}
-				line_no++; //Increment line
-				SkipComments(); //Repeat
-			}
-			else //Else an error
-				syntax_error();
-		}
-		else //Else not a comment
-			input.UngetChar(c);
-	}
-}
-
-//Checks if an item is a keyword
-bool LexicalAnalyzer::IsKeyword(string s)
-{
-    for (int i = 0; i < KEYWORDS_COUNT; i++)
-    {
-        if (s == keyword[i])
-            return true;
-    }
-    return false;
-}
-
-//Finds the location of a keyword
-TokenType LexicalAnalyzer::FindKeywordIndex(string s)
-{
-    for (int i = 0; i < KEYWORDS_COUNT; i++)
-    {
-        if (s == keyword[i])
-            return (TokenType) (i + 1);
-    }
-    return ERROR;
-}
-
-//Checks the type of number
-Token LexicalAnalyzer::ScanNumber()
-{
-    char c;
-    bool isREALNUM = false;
-	
-    input.GetChar(c);
-    if (c == '0') //Check for only REALNUM
-    {
-        tmp.lexeme = "0";
-        input.GetChar(c);
-        if(c == '.') //Check for DOT
-        {
-            input.GetChar(c);
-            if(isdigit(c)) //Is REALNUM
-            {
-                while (!input.EndOfInput() && isdigit(c)) //Get REALNUM
-                {
-                    tmp.lexeme += c;
-                    isREALNUM = true;
-                    input.GetChar(c);
-                }
-                input.UngetChar(c);
-			}
-            else //Else not REALNUM
-                input.UngetChar(c);
-        }
-        else //Else not a REALNUM
-            input.UngetChar(c);
-    }
-    else //Check for NUM & REALNUM
-    {
-        tmp.lexeme = "";
-        while (!input.EndOfInput() && isdigit(c)) //Get NUM
-        {
-            tmp.lexeme += c;
-            input.GetChar(c);
-        }
-		
-        if(c == '.') //Check for DOT
-        {               
-            input.GetChar(c);
-            if(isdigit(c)) //Is REALNUM
-            {
-                while (!input.EndOfInput() && isdigit(c)) //Get REALNUM
-                {
-                    tmp.lexeme += c;
-                    isREALNUM = true;
-                    input.GetChar(c);
-                }
-			}
-            else //Else not REALNUM
-				input.UngetChar(c);
-        }
-		
-        if (!input.EndOfInput()) //Check for EOF
-            input.UngetChar(c);
-    }
-	
-    if(isREALNUM) //Is REALNUM
-        tmp.token_type = REALNUM;
-    else //Is NUM
-        tmp.token_type = NUM;
-	
-    tmp.line_no = line_no;
-    return tmp;
+    records = NULL;
+    pool = NULL;
+    recordCount = poolSize = nextRecord = 0;
+    queue = NULL;
 }
 
-//Scans for a Keyword or ID
-Token LexicalAnalyzer::ScanIdOrKeyword()
+//A / that does not start a comment
+void projectTokens::BadComment()
 {
-    char c;
-    input.GetChar(c);
-
-    if (isalpha(c))
-    {
-        tmp.lexeme = "";
-        while (!input.EndOfInput() && isalnum(c))
-        {
-            tmp.lexeme += c;
-            input.GetChar(c);
-        }
-        
-		if (!input.EndOfInput())
-            input.UngetChar(c);
-        tmp.line_no = line_no;
-
-        if (IsKeyword(tmp.lexeme))
-             tmp.token_type = FindKeywordIndex(tmp.lexeme);
-        else
-            tmp.token_type = ID;
-    }
-    else
-    {
-        if (!input.EndOfInput())
-            input.UngetChar(c);
-        tmp.lexeme = "";
-        tmp.token_type = ERROR;
-    }
-    return tmp;
+    syntax_error();
 }
 
-//Puts a token back
-TokenType LexicalAnalyzer::UngetToken(Token tok)
+//Counts the tokens put back & not taken again yet
+int LexicalAnalyzer::BufferedTokens()
 {
-    tokens.push_back(tok);;
-    return tok.token_type;
+    return tokens.size();
 }
 
-//Gets Token from the input
+//Gets Token from the token file, the lexing thread or the shared lexer core
 Token LexicalAnalyzer::GetToken()
 {
-    char c;
     if (!tokens.empty())
     {
         tmp = tokens.back();
         tokens.pop_back();
         return tmp;
     }
-
-    SkipSpace(); //Skip spacing
-    SkipComments(); //Skip comments
-    SkipSpace(); //Skip spacing after comments
-    tmp.lexeme = "";
-    tmp.line_no = line_no;
-    input.GetChar(c);
-    switch (c)
-    {
-        case '!':
-            tmp.token_type = NOT;
-            return tmp;
-        case '+':
-            tmp.token_type = PLUS;
-            return tmp;
-        case '-':
-            tmp.token_type = MINUS;
-            return tmp;
-        case '*':
-            tmp.token_type = MULT;
-            return tmp;
-        case '/':
-            tmp.token_type = DIV;
-            return tmp;
-        case '(':
-            tmp.token_type = LPAREN;
-            return tmp;
-        case ')':
-            tmp.token_type = RPAREN;
-            return tmp;
-        case '=':
-            tmp.token_type = EQUAL;
-            return tmp;
-        case ':':
-            tmp.token_type = COLON;
-            return tmp;
-        case ',':
-            tmp.token_type = COMMA;
-            return tmp;
-        case ';':
-            tmp.token_type = SEMICOLON;
-            return tmp;
-        case '{':
-            tmp.token_type = LBRACE;
-            return tmp;
-        case '}':
-            tmp.token_type = RBRACE;
-            return tmp;
-        case '<':
-            input.GetChar(c);
-            if(c == '=') //Check for Less than Equal
-                tmp.token_type = LTEQ;
-            else if (c == '>') //Check for Not Equal
-                tmp.token_type = NOTEQUAL;
-            else //Just Less than
-            {
-                input.UngetChar(c);
-                tmp.token_type = LESS;
-            }
-            return tmp;
-		case '>':
-            input.GetChar(c);
-            if(c == '=') //Check for Greater than Equal
-                tmp.token_type = GTEQ;
-            else //Just Greater than
-            {
-                input.UngetChar(c);
-                tmp.token_type = GREATER;
-            }
-            return tmp;
-        default:
-            if (isdigit(c)) //Check for Num Type
-            {
-                input.UngetChar(c);
-                return ScanNumber();
-            }
-            else if (isalpha(c)) //Check for ID
-            {
-                input.UngetChar(c);
-                return ScanIdOrKeyword();
-            }
-            else if (input.EndOfInput()) //EOF
-                tmp.token_type = END_OF_FILE;
-            else
-                tmp.token_type = ERROR;
-            return tmp;
-    }
+    phaseTimer scan(PHASE_SCAN);
+    if (records != NULL) //Read from a token file instead
+        return ReplayToken();
+    if (queue != NULL) //Take what the lexing thread made instead
+        return PipedToken();
+    return Scan();
 }
 
 //*************************************
@@ -390,6 +94,7 @@ Token LexicalAnalyzer::GetToken()
 //Parses the list of variables
 void parse_var_list()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     add_to_list(token.lexeme, 0);
     if(token.token_type == ID) //Check for ID
@@ -409,6 +114,7 @@ void parse_var_list()
 //Parses Unary Operator NOT
 void parse_unary_operator()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type != NOT)
         syntax_error();
@@ -417,6 +123,7 @@ void parse_unary_operator()
 //Checks type of binary operator & returns token value
 int parse_binary_operator()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
 	int binary = -1;
 	
@@ -443,6 +150,7 @@ int parse_binary_operator()
     else //Else there is an error
         syntax_error();
 	
+    record_operator(token.token_type); //Keeps > apart from >= for run_program
 	return binary;
 }
 
@@ -491,11 +199,12 @@ bool is_binary_operator(int op)
 //Parses the Primary Type of the item & returns token value
 int parse_primary()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
 	int numType = -1;
 	
     if(token.token_type == ID) //For ID
-        numType = search_table(token.lexeme);
+        return combine_variable(token.lexeme);
     else if(token.token_type == NUM) //For Int
         numType = 1;
     else if(token.token_type == REALNUM) //For Real Num
@@ -507,12 +216,138 @@ int parse_primary()
     else //Else there is an error
         syntax_error();
 	
+    record_constant(token);
+    if(batchInference) //Record the constant for the solver
+        numType = emit_constraint(LOAD_CONST, numType, 0, 0);
 	return numType;
 }
 
-//Parses expressions
+//Looks up the type of a variable now, or records the lookup for the solver
+int combine_variable(string name)
+{
+    scopeTableItem* item = lookup_item(name);
+    record_variable(item->index);
+    if(batchInference)
+        return emit_constraint(LOAD_VAR, item->index, 0, 0);
+    return item->type;
+}
+
+//Types a binary operator now, or records it for the solver
+int combine_binary(int op, int LHS, int RHS)
+{
+    int type;
+    record_binary();
+    if(batchInference)
+        return emit_constraint(BINARY_OP, LHS, RHS, op);
+	
+    int code = check_binary(op, LHS, RHS, type, NULL);
+    if(code != 0) //Else a type mismatch
+        type_mismatch(token.line_no, code);
+    return type;
+}
+
+//Types the operand of NOT now, or records it for the solver
+int combine_not(int type)
+{
+    record_not();
+    if(batchInference)
+        return emit_constraint(UNARY_NOT, type, 0, 0);
+	
+    if(check_not(type) != 0) //Else a type mismatch
+        type_mismatch(token.line_no, 3);
+    return type;
+}
+
+//Types an assignment now, or records it for the solver
+void combine_assignment(int LHS, int RHS)
+{
+    record_assignment();
+    if(batchInference)
+        emit_constraint(ASSIGN, LHS, RHS, 0);
+    else if(check_assignment(LHS, RHS, NULL) != 0) //Else a mismatch
+        type_mismatch(token.line_no, 1);
+}
+
+//Types an if, while or switch condition now, or records it for the solver
+void combine_condition(int type, int code)
+{
+    if(batchInference)
+        emit_constraint(CONDITION, type, 0, code);
+    else if(check_condition(type, code) != 0) //Else a mismatch
+        type_mismatch(token.line_no, code);
+}
+
+//An operator waiting for its operands in parse_expression
+struct pendingOperator
+{
+    int op;          //Binary operator code, or NOT
+    int LHS;         //Type of the left operand once parsed
+    bool haveLHS;
+};
+
+//Parses expressions with an explicit operator stack, so nesting depth costs no native stack
 int parse_expression()
 {
+    traceSpan span(__func__);
+    if(recursiveExpressions)
+        return parse_expression_recursive();
+	
+    static vector<pendingOperator> pending; //Kept between expressions, so a parse reuses its room instead of allocating
+    pending.clear();
+    int type;
+	
+    while(true)
+    {
+        token = lexer.GetToken();
+        if(token.token_type == ID || token.token_type == NUM || token.token_type == REALNUM || token.token_type == TR || token.token_type == FA) //Check for primary
+        {
+            lexer.UngetToken(token);
+            type = parse_primary(); //Parse primary
+			
+            while(!pending.empty()) //Apply every operator this operand completes
+            {
+                pendingOperator& top = pending.back();
+                if(top.op == NOT) //Check for BOOL
+                    type = combine_not(type);
+                else if(!top.haveLHS) //Left operand done, parse the right one next
+                {
+                    top.LHS = type;
+                    top.haveLHS = true;
+                    break;
+                }
+                else //Check operands
+                    type = combine_binary(top.op, top.LHS, type);
+                pending.pop_back();
+            }
+            if(pending.empty())
+                return type;
+        }
+        else if(is_binary_operator(token.token_type)) //Check for an operator
+        {
+            pendingOperator next;
+            lexer.UngetToken(token);
+            next.op = parse_binary_operator(); //Parse binary operator
+            next.haveLHS = false;
+            pending.push_back(next);
+        }
+        else if(token.token_type == NOT) //Check for NOT
+        {
+            pendingOperator next;
+            lexer.UngetToken(token);
+            parse_unary_operator(); //Parse unary_operator
+            next.op = NOT;
+            next.haveLHS = false;
+            pending.push_back(next);
+        }
+        else //Else an error
+            syntax_error();
+    }
+}
+
+//Parses expressions by recursing into each operand, kept for comparison with parse_expression
+int parse_expression_recursive()
+{
+    traceSpan span(__func__);
     int type;
     token = lexer.GetToken();
     if(token.token_type == ID || token.token_type == NUM || token.token_type == REALNUM || token.token_type == TR || token.token_type == FA) //Check for primary
@@ -525,56 +360,16 @@ int parse_expression()
         int LHS, RHS;
 		lexer.UngetToken(token);
         type = parse_binary_operator(); //Parse binary operator
-        LHS = parse_expression(); //Parse left expression
-        RHS = parse_expression(); //Parse right expression
-        if((LHS != RHS) || !(is_binary_operator(type)))
-        {
-            if(type == PLUS || type == MINUS || type == MULT || type == DIV) //Check which operator type
-            {
-                if(LHS <= 2 && RHS > 3)
-                {
-                    update_type(RHS, LHS);
-                    RHS = LHS;
-                }
-                else if(LHS > 3 && RHS <= 2)
-                {
-                    update_type(RHS, LHS);
-                    LHS = RHS;
-                }
-                else if(LHS > 3 && RHS > 3)
-                {
-                    update_type(RHS, LHS);
-                    RHS = LHS;
-                }
-                else //Else a type mismatch
-                    type_mismatch(token.line_no, 2);
-            }
-            else if(type == GTEQ || type == GREATER || type == LTEQ || type == LESS || type == NOTEQUAL || type == EQUAL) //Check which operator type
-            {
-                if(RHS > 3 && LHS > 3)
-                {
-                    update_type(RHS, LHS);
-                    RHS = LHS;
-                    return 3;
-                }
-                else //Else a type mismatch
-                    type_mismatch(token.line_no, 2);
-            }
-            else //Else a type mismatch
-                type_mismatch(token.line_no, 2);
-        }
-        if(type == GTEQ || type == GREATER || type == LTEQ || type == LESS || type == EQUAL) //Check for excluding NOTEQUAL
-            type = 3;
-        else
-            type = RHS;
+        LHS = parse_expression_recursive(); //Parse left expression
+        RHS = parse_expression_recursive(); //Parse right expression
+        type = combine_binary(type, LHS, RHS); //Check operands
     }
     else if(token.token_type == NOT) //Check for NOT
     {
         lexer.UngetToken(token);
         parse_unary_operator(); //Parse unary_operator
-        type = parse_expression(); //Parse expression
-        if(type != 3)
-            type_mismatch(token.line_no, 3);
+        type = parse_expression_recursive(); //Parse expression
+        type = combine_not(type); //Check for BOOL
     }
     else //Else an error
         syntax_error();
@@ -584,9 +379,12 @@ int parse_expression()
 //Updates the variables in the list
 void update_type(int current, int newType)
 {
+    phaseTimer unify(PHASE_UNIFY);
     scopeTable* iterator = symbolTable;
+    STAT_COUNT(UPDATE_VISITS); //The last node
     while(iterator->next != NULL) //Search the list of variables
     {
+        STAT_COUNT(UPDATE_VISITS);
         if(iterator->item->type == current) //Found & updated
             iterator->item->type = newType;
         iterator = iterator->next; //Next node
@@ -658,11 +456,13 @@ bool is_expression(int expressionType)
 //Parses the assignment statement
 void parse_assignment_stmt()
 {
+    traceSpan span(__func__);
     int LHS, RHS;
     token = lexer.GetToken();
     if(token.token_type == ID) //Check for ID
     {
-        LHS = search_table(token.lexeme); //Search list of variables
+        begin_statement(); //Constraints from here belong to this statement
+        LHS = combine_variable(token.lexeme); //Search list of variables
         token = lexer.GetToken();
         if(token.token_type == EQUAL) //Check for EQUAL
         {
@@ -671,24 +471,7 @@ void parse_assignment_stmt()
             {
                 lexer.UngetToken(token);
                 RHS = parse_expression(); //Parse 
-                if(LHS == 1 || LHS == 2 || LHS == 3) //Check for INT, REAL, BOOL
-                {
-                    if(LHS != RHS)
-					{
-                        if(LHS > 2) //Check for LHS - RHS compatible
-                        {
-                            update_type(RHS,LHS);
-                            RHS = LHS;
-                        }
-                        else //Else a mismatch
-							type_mismatch(token.line_no, 1);
-                    }
-                }
-                else //Compatible
-                {
-                    update_type(LHS,RHS);
-                    LHS = RHS;
-                }
+                combine_assignment(LHS, RHS); //Check LHS - RHS compatible
 				
                 token = lexer.GetToken();
                 if(token.token_type != SEMICOLON) //Check for semicolon
@@ -707,17 +490,20 @@ void parse_assignment_stmt()
 //Parse the case
 void parse_case()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == CASE) //Check for CASE
     {
         token = lexer.GetToken();
         if(token.token_type == NUM) //Check for NUM
         {
+            open_statement(STMT_CASE); //Body belongs to this case
             token = lexer.GetToken();
             if(token.token_type == COLON) //Check for COLON
                 parse_body(); //Parse body
             else //Else an error
                 syntax_error();
+            close_statement();
         }
         else //Else an error
             syntax_error();
@@ -729,6 +515,7 @@ void parse_case()
 //Parse the list of cases
 void parse_case_list()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == CASE) //Check for CASE
     {
@@ -749,15 +536,17 @@ void parse_case_list()
 //Parses SWITCH statement structures
 void parse_switch_stmt()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == SWITCH) //Check for SWITCH
     {
         token = lexer.GetToken();
         if(token.token_type == LPAREN) //Check for LPAREN
         {
+            begin_statement(); //Constraints from here belong to this condition
             int temp = parse_expression(); //Check for expression
-            if(temp <= 3 && temp != 1)
-                type_mismatch(token.line_no, 5);
+            combine_condition(temp, 5); //Check for matching INT
+            open_statement(STMT_SWITCH); //Cases belong to this switch
 			
             token = lexer.GetToken();
             if(token.token_type == RPAREN) //Check for RPAREN
@@ -769,6 +558,7 @@ void parse_switch_stmt()
                     token = lexer.GetToken();
                     if(token.token_type != RBRACE) //Check for RBRACE
                         syntax_error();
+                    close_statement();
                 }
                 else //Else an error
                     syntax_error();
@@ -786,21 +576,24 @@ void parse_switch_stmt()
 //Parses WHILE statement structures
 void parse_while_stmt()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == WHILE) //Check for WHILE
     {
         token = lexer.GetToken();
         if(token.token_type == LPAREN) //Check for LPAREN
         {
+            begin_statement(); //Constraints from here belong to this condition
             int temp = parse_expression(); //Check for expression
-            if(temp != 3) //Check for matching BOOL
-                type_mismatch(token.line_no, 4);
+            combine_condition(temp, 4); //Check for matching BOOL
+            open_statement(STMT_WHILE); //Body belongs to this loop
 			
             token = lexer.GetToken();
             if(token.token_type == RPAREN) //Check for RPAREN
                 parse_body();
             else //Else an error
                 syntax_error();
+            close_statement();
         }
         else //Else an error
             syntax_error();
@@ -812,21 +605,24 @@ void parse_while_stmt()
 //Parses IF statement structures
 void parse_if_stmt()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == IF) //Check for IF
     {
         token = lexer.GetToken();
         if(token.token_type == LPAREN) //Check for LPAREN
         {
+            begin_statement(); //Constraints from here belong to this condition
             int temp = parse_expression(); //Check for expression
-            if(temp != 3) //Check for matching BOOL
-                type_mismatch(token.line_no, 4);
+            combine_condition(temp, 4); //Check for matching BOOL
+            open_statement(STMT_IF); //Body belongs to this if
 
             token = lexer.GetToken();
             if(token.token_type == RPAREN)
                 parse_body();
             else //Else an error
                 syntax_error();
+            close_statement();
         }
         else //Else an error
             syntax_error();
@@ -838,6 +634,11 @@ void parse_if_stmt()
 //Parse statements for statement function
 void parse_stmt()
 {
+    traceSpan span(__func__);
+    bool top = editSession && bodyDepth == 1; //Edit sessions track statements of the program body
+    if(top)
+        begin_top_statement();
+
     token = lexer.GetToken();
 	lexer.UngetToken(token);
 	
@@ -851,11 +652,15 @@ void parse_stmt()
         parse_switch_stmt(); //Parse switch
     else //Else an error
         syntax_error();
+
+    if(top)
+        end_top_statement();
 }
 
 //Parse the list of statements
 void parse_stmt_list()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == ID || token.token_type == IF || token.token_type == WHILE || token.token_type == SWITCH) //Check for stmt
     {
@@ -877,10 +682,13 @@ void parse_stmt_list()
 //Parses the body of the code
 void parse_body()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == LBRACE) //Check for LBRACE
     {
+        bodyDepth++;
         parse_stmt_list(); //Parse the statement list
+        bodyDepth--;
         token = lexer.GetToken();
         if(token.token_type != RBRACE) //Check for RBRACE
             syntax_error();
@@ -891,23 +699,35 @@ void parse_body()
         syntax_error();
 }
 
+//Gives the declared type to the variables listed on this line
+void declare_type(int type)
+{
+    if(batchInference) //Record for the solver
+    {
+        begin_statement();
+        emit_constraint(DECLARE, symbolCount, 0, type);
+        return;
+    }
+	
+    scopeTable* iterator = symbolTable; //Compare with the list
+    while(iterator->next != NULL)
+    {
+        if(iterator->item->line_no == token.line_no) //Found
+            iterator->item->type = type;
+        iterator = iterator->next; //Next node
+    }
+	
+    if(iterator->item->line_no == token.line_no) //Check last node
+        iterator->item->type = type;
+}
+
 //Parses the type name
 void parse_type_name()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == INT || token.token_type == REAL || token.token_type == BOO) //Check for token type
-    {
-		scopeTable* iterator = symbolTable; //Compare with the list
-		while(iterator->next != NULL)
-		{
-			if(iterator->item->line_no == token.line_no) //Found
-				iterator->item->type = token.token_type;
-			iterator = iterator->next; //Next node
-		}
-		
-		if(iterator->item->line_no == token.line_no) //Check last node
-			iterator->item->type = token.token_type;
-    }
+        declare_type(token.token_type);
     else //Else an error
         syntax_error();
 }
@@ -915,6 +735,7 @@ void parse_type_name()
 //Parses the declared variable
 void parse_var_decl()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
 	
     if(token.token_type == ID) //Check for ID in var_list
@@ -939,6 +760,7 @@ void parse_var_decl()
 //Parses the declared variable list
 void parse_var_decl_list()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     while(token.token_type == ID) //Check for ID in var_list
     {
@@ -952,6 +774,7 @@ void parse_var_decl_list()
 //Parses Global Vars
 void parse_global_vars()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     if(token.token_type == ID) //Check for ID in var_list
     {
@@ -965,6 +788,7 @@ void parse_global_vars()
 //Parses the program
 void parse_program()
 {
+    traceSpan span(__func__);
     token = lexer.GetToken();
     while (token.token_type != END_OF_FILE)
     {
@@ -986,9 +810,18 @@ void parse_program()
     }
 }
 
+//Keyword of a known type; a variable whose type name is on a later line is never declared & keeps type 0
+string type_keyword(int type)
+{
+    if(type == 0) //Printed as ERROR, as the old keyword table did
+        return "ERROR";
+    return string(projectTokens::keywords[type - 1]);
+}
+
 //Prints the final output by iterating through the list of tables
 void print_list()
 {
+    phaseTimer printing(PHASE_OUTPUT);
     scopeTable* iterator = symbolTable;
 	string output = "";
     string lCase;
@@ -1021,7 +854,7 @@ void print_list()
         }
         else if(iterator->item->type < 4 && iterator->item->printed == false) //For type known
         {
-            lCase = keyword[(iterator->item->type) - 1]; //Collect keyword, type, edit print
+            lCase = type_keyword(iterator->item->type); //Collect keyword, type, edit print
             type = iterator->item->type;
 			iterator->item->printed = true;
 			
@@ -1034,7 +867,7 @@ void print_list()
             {
                 iterator = iterator->next; //Iterate
 				
-                lCase = keyword[(iterator->item->type) - 1]; //Collect keyword, type, edit print
+                lCase = type_keyword(iterator->item->type); //Collect keyword, type, edit print
 				iterator->item->printed = true;
 				
                 output = iterator->item->name + ": " + lCase + " #"; //Format output
@@ -1055,7 +888,7 @@ void print_list()
     }
     else if(iterator->item->type <= 3 && iterator->item->printed == false) //For type known
     {        
-        lCase = keyword[(iterator->item->type) - 1];
+        lCase = type_keyword(iterator->item->type);
         output += iterator->item->name + ": " + lCase + " #";
         cout << output <<endl;
     }
@@ -1082,13 +915,23 @@ void type_mismatch(int line_no, int type)
 			cout << "TYPE MISMATCH " << line_no << " C5" << endl;
 			break;
 	}
+    if(editSession) //The session goes on with the next edit
+        throw checkStopped();
+    checkStatus = 1;
 	exit(1);
 }
 
 //Handles syntax errors
 void syntax_error()
 {
+    if(quietErrors) //Only trying a parse or a lex
+        throw checkStopped();
+    if(batchInference) //A mismatch before this point is reported first
+        solve_constraints();
     cout << "\nSyntax Error\n";
+    if(editSession) //The session goes on with the next edit
+        throw checkStopped();
+    checkStatus = 1;
     exit(1);
 }
 
@@ -1099,24 +942,24 @@ void syntax_error()
 //START LIST FUNCTIONS
 
 //Adds items to the scope table
-void add_to_list(string name, int type)
+scopeTableItem* add_to_list(string name, int type)
 {
-    if(symbolTable == NULL) //Create a new table
-    {
-        scopeTable* newTable = new scopeTable();
-        scopeTableItem* newItem = new scopeTableItem();
+    scopeTable* newTable = new scopeTable(); //Create new entries
+    scopeTableItem* newItem = new scopeTableItem();
 
-        newItem->name = name; //Add name
-        newItem->line_no = token.line_no; //Add line
-        newItem->type = type; //Add type
-        newItem->printed = false; //Not printed
+    newItem->name = name; //Add name
+    newItem->line_no = token.line_no; //Add line
+    newItem->type = type; //Add type
+    newItem->index = symbolCount++; //Add position in the list
+    newItem->printed = false; //Not printed
 
-        newTable->item = newItem; //Setup table
-        newTable->next = NULL;
+    newTable->item = newItem;
+    newTable->next = NULL;
+	
+    if(symbolTable == NULL) //Create a new table
+    {
         newTable->prev = NULL;
-
         symbolTable = newTable;
-
     }
     else //Add to existing table
     {
@@ -1126,61 +969,120 @@ void add_to_list(string name, int type)
             iterator = iterator->next;
         }
 
-        scopeTable* newTable = new scopeTable(); //Create new entries
-        scopeTableItem* newItem = new scopeTableItem();
-
-        newItem->name = name; //Add name
-        newItem->line_no = token.line_no; //Add line
-        newItem->type = type; //Add type
-        newItem->printed = false; //Not printed
-
-        newTable->item = newItem; //Add to the end
-        newTable->next = NULL;
-        newTable->prev = iterator;
+        newTable->prev = iterator; //Add to the end
         iterator->next = newTable;
     }
+    return newItem;
 }
 
-//Searches the list of tables for the scope
-int search_table(string name)
+//Searches the list of tables for the item, adding it if it is new
+scopeTableItem* lookup_item(string name)
 {
+    phaseTimer lookup(PHASE_LOOKUP);
     scopeTable* iterator = symbolTable;
 	
-    if (symbolTable == NULL) //Check if table exists
+    while(iterator != NULL) //Check the list
     {
-        add_to_list(name, enumCount);
-        enumCount++;
-        return 4;
-    }
-    else //Search through the list for item
-    {
-        while(iterator->next != NULL) //Check the list
-        {
-            if(iterator->item->name == name)
-                return iterator->item->type;
-            else
-                iterator = iterator->next;
-        }
-		
-        if(iterator->item->name == name) //Check the final node
-            return iterator->item->type;
-        else //Else add to list
-        {
-            add_to_list(name, enumCount);
-            enumCount++;
-            return (enumCount - 1);
-        }
+        STAT_COUNT(TABLE_PROBES);
+        if(iterator->item->name == name)
+            return iterator->item;
+        iterator = iterator->next;
     }
+	
+    scopeTableItem* newItem = add_to_list(name, enumCount); //Else add to list
+    enumCount++;
+    return newItem;
+}
+
+//Searches the list of tables for the scope
+int search_table(string name)
+{
+    return lookup_item(name)->type;
 }
 
 //*************************************
 //END LIST FUNCTIONS
 
 //Driver Code
-int main()
+int main(int argc, char* argv[])
 {
-    parse_program();
+    for(int i = 1; i < argc; i++) //Check for options
+    {
+        if(strcmp(argv[i], "-batch") == 0) //Defer type inference until after parsing
+            batchInference = true;
+        else if(strcmp(argv[i], "-parallel") == 0) //Solve independent statements on several threads
+            batchInference = parallelInference = true;
+        else if(strcmp(argv[i], "-threads") == 0 && i + 1 < argc) //Thread count for -parallel
+            inferenceThreads = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-recursive") == 0) //Parse expressions recursively
+            recursiveExpressions = true;
+        else if(strcmp(argv[i], "-table") == 0) //Use the table-driven LL(1) parser
+            tableParser = true;
+        else if(strcmp(argv[i], "-run") == 0) //Execute the program after checking it
+            recordProgram = true;
+        else if(strcmp(argv[i], "-columns") == 0 && i + 1 < argc) //Execute once per record of a CSV file
+        {
+            columnInput = argv[++i];
+            recordProgram = true;
+        }
+        else if(strcmp(argv[i], "-nofold") == 0) //Keep constant subexpressions for -run, -columns & -emit-c
+            foldConstants = false;
+        else if(strcmp(argv[i], "-emit-c") == 0) //Print the program as C instead of the types
+            emitC = recordProgram = true;
+        else if(strcmp(argv[i], "-edits") == 0 && i + 1 < argc) //Re-check after each edit in a file
+            editInput = argv[++i];
+        else if(strcmp(argv[i], "-cache") == 0 && i + 1 < argc) //Reuse results of identical runs
+            cachePath = argv[++i];
+        else if(strcmp(argv[i], "-cache-stats") == 0) //Print the cache counters on stderr
+            cacheStats = true;
+        else if(strcmp(argv[i], "-tokens-out") == 0 && i + 1 < argc) //Save the tokens of the input to a file
+            tokenOutput = argv[++i];
+        else if(strcmp(argv[i], "-tokens-in") == 0 && i + 1 < argc) //Parse the tokens of a file instead of the input
+            tokenInput = argv[++i];
+        else if(strcmp(argv[i], "-tokens-check") == 0 && i + 1 < argc) //Compare a token file with the input
+            tokenCheck = argv[++i];
+        else if(strcmp(argv[i], "-pipeline") == 0) //Lex on a second thread while parsing
+            pipelineLexer = true;
+    }
+
+    start_stats("Project3", tokenInput == NULL);
+    start_trace();
+    if(tokenCheck != NULL)
+        return check_token_file(tokenCheck);
+    if(cachePath != NULL && columnInput == NULL && editInput == NULL && tokenOutput == NULL && tokenInput == NULL) //Other inputs are files the key does not cover
+        open_result_cache(argc, argv);
+
+    if(editInput != NULL)
+    {
+        run_edit_session();
+        return 0;
+    }
+    open_token_files();
+    if(pipelineLexer && tokenOutput == NULL && tokenInput == NULL)
+        lexer.StartPipeline();
+	
+    {
+        phaseTimer parse(PHASE_PARSE);
+        if(tableParser)
+            parse_program_table();
+        else
+            parse_program();
+    }
+    if(parallelInference)
+        solve_constraints_parallel();
+    else if(batchInference)
+        solve_constraints();
+    if(emitC)
+    {
+        phaseTimer printing(PHASE_OUTPUT);
+        emit_c_program();
+        return 0;
+    }
     print_list();
+    if(columnInput != NULL)
+        run_columns();
+    else if(recordProgram)
+        run_program();
 	
     return 0;
 }
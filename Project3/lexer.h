@@ -3,8 +3,12 @@
 
 #include <vector>
 #include <string>
+#include <ostream>
+#include <type_traits>
+#include <string.h>
 
-#include "inputbuf.h"
+#include "../common/stats.h"
+#include "../lexcore/lexcore.h"
 
 // ------- token types -------------------
 
@@ -17,35 +21,97 @@ typedef enum { END_OF_FILE = 0,
 			   LBRACE, RBRACE, ID, ERROR
 } TokenType;
 
+// ------- tokens ------------------------
+
 class Token 
 {
   public:
     void Print();
 
-    std::string lexeme;
+    Lexeme lexeme;
     TokenType token_type;
     int line_no;
 };
 
-class LexicalAnalyzer 
+static_assert(std::is_trivially_copyable<Token>::value, "tokens copy as plain bytes");
+
+// ------- token files -------------------
+
+#define TOKEN_FILE_MAGIC 0x4e4b4f5430343343ULL //"C340TOKN"
+#define TOKEN_FILE_VERSION 1
+#define TOKEN_SET 3                            //Project3 tokens; other token sets are rejected
+#define TOKEN_LEX_ERROR 0xff                   //Type of the record where the lexer stopped at a lone /
+
+//Start of a token file, followed by the records & the lexeme pool
+struct tokenFileHeader
+{
+    unsigned long long magic;
+    unsigned int version;
+    unsigned int tokenSet;
+    unsigned int count;      //Records, the last being END_OF_FILE or TOKEN_LEX_ERROR
+    unsigned int poolSize;   //Bytes of interned lexemes
+};
+
+//One token: its lexeme is pool[lexeme, lexeme + length)
+struct tokenRecord
+{
+    unsigned int line_no;
+    unsigned int lexeme;
+    unsigned int typeLength; //Type in the top 8 bits, length below
+};
+
+struct tokenQueue; //Ring of tokens from a lexing thread, in pipeline.cc
+
+// ------- token set ---------------------
+
+//Project3's tokens, for the shared lexer core
+struct projectTokens
+{
+    typedef Token token;
+    typedef TokenType type;
+
+    static constexpr type endOfFile = END_OF_FILE, error = ERROR, id = ID;
+    static constexpr std::string_view keywords[] = { "int", "real", "bool", "true", "false", "if", "while", "switch", "case", "public", "private" };
+    static constexpr punctuator<type> punctuators[] =
+    {
+        { '!', NOT }, { '+', PLUS }, { '-', MINUS }, { '*', MULT }, { '/', DIV }, { '(', LPAREN }, { ')', RPAREN },
+        { '=', EQUAL }, { ':', COLON }, { ',', COMMA }, { ';', SEMICOLON }, { '{', LBRACE }, { '}', RBRACE },
+        { '<', LESS, '=', LTEQ, '>', NOTEQUAL }, { '>', GREATER, '=', GTEQ }
+    };
+    static constexpr numberStyle numbers = REAL_NUMBERS;
+    static constexpr type num = NUM, realNum = REALNUM, base08Num = ERROR, base16Num = ERROR;
+    static constexpr commentStyle comments = STRICT_COMMENTS;
+    static constexpr type loneSlash = DIV;
+    static constexpr bool pairUngetsAtEnd = true;
+    static constexpr bool keywordPrefixes = false;
+
+    static void BadComment(); //A syntax error
+};
+
+extern template class LexerCore<projectTokens, StreamSource>; //Built optimized in scanner.cc
+
+class LexicalAnalyzer : public LexerCore<projectTokens>
 {
   public:
     Token GetToken();
-    TokenType UngetToken(Token);
+    int BufferedTokens();
+    bool WriteTokens(const char*);
+    bool MapTokens(const char*);
+    void StartPipeline(); //Lexes on a thread of its own from here on
     LexicalAnalyzer();
 
   private:
-    std::vector<Token> tokens;
-    int line_no;
-    Token tmp;
-    InputBuffer input;
-
-    void SkipSpace();
-    void SkipComments();
-    bool IsKeyword(std::string);
-    TokenType FindKeywordIndex(std::string);
-    Token ScanIdOrKeyword();
-    Token ScanNumber();
+    const tokenRecord* records; //Mapped token file GetToken reads instead of the input, or NULL
+    const char* pool;
+    unsigned int recordCount;
+    unsigned int poolSize;
+    unsigned int nextRecord;
+    tokenQueue* queue;          //Ring GetToken takes tokens from instead of the input, or NULL
+
+    Token ReplayToken();
+    Token PipedToken();
+
+    friend struct benchAccess; //The micro benchmarks time the scanners on their own
 };
 
 #endif  //__LEXER__H__
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "lexer.h"
+#include "parser.h"
+#include "../common/trace.h"
+
+using namespace std;
+
+//*************************************
+//START GRAMMAR
+
+//Terminals are the TokenType values, nonterminals & actions follow them
+#define TERMINAL_COUNT 34
+#define FIRST_NONTERMINAL 40
+#define FIRST_ACTION 80
+
+enum nonterminal
+{
+    NT_PROGRAM = FIRST_NONTERMINAL, NT_AFTER_VARS, NT_GLOBAL_VARS, NT_VAR_DECL_MORE, NT_VAR_DECL,
+    NT_VAR_LIST, NT_VAR_LIST_MORE, NT_TYPE_NAME, NT_BODY, NT_STMT_LIST, NT_STMT_MORE, NT_STMT,
+    NT_ASSIGNMENT, NT_IF, NT_WHILE, NT_SWITCH, NT_CASE_LIST, NT_CASE_MORE, NT_CASE,
+    NT_END
+};
+#define NONTERMINAL_COUNT (NT_END - FIRST_NONTERMINAL)
+
+//Actions run when they reach the top of the stack; EXPR parses a whole expression
+enum action
+{
+    ACT_EXPR = FIRST_ACTION, //Push the type of parse_expression
+    ACT_ADD_VAR,             //Add the matched ID to the list of variables
+    ACT_DECLARE,             //Declare the variables on the matched type's line
+    ACT_STATEMENT,           //Start the constraints of a statement
+    ACT_LHS,                 //Push the type of the matched ID
+    ACT_ASSIGN,              //Pop RHS & LHS, rule C1
+    ACT_IF_WHILE,            //Pop a condition, rule C4
+    ACT_SWITCH,              //Pop a condition, rule C5
+    ACT_OPEN_IF,             //Start recording an if body for run_program
+    ACT_OPEN_WHILE,          //Start recording a while body
+    ACT_OPEN_SWITCH,         //Start recording a switch's cases
+    ACT_OPEN_CASE,           //Start recording the matched case's body
+    ACT_CLOSE                //End the innermost recorded body
+};
+
+#define MAX_RHS 11
+
+struct production
+{
+    int lhs;
+    int length;
+    int rhs[MAX_RHS];
+};
+
+//The Project3 grammar, with the actions where parse_* does its typing
+constexpr production grammar[] =
+{
+    { NT_PROGRAM, 2, { NT_BODY, NT_PROGRAM } },
+    { NT_PROGRAM, 2, { NT_GLOBAL_VARS, NT_AFTER_VARS } },
+    { NT_PROGRAM, 0, { } },
+    { NT_AFTER_VARS, 2, { NT_BODY, NT_PROGRAM } },
+    { NT_AFTER_VARS, 0, { } },
+    { NT_GLOBAL_VARS, 2, { NT_VAR_DECL, NT_VAR_DECL_MORE } },
+    { NT_VAR_DECL_MORE, 2, { NT_VAR_DECL, NT_VAR_DECL_MORE } },
+    { NT_VAR_DECL_MORE, 0, { } },
+    { NT_VAR_DECL, 4, { NT_VAR_LIST, COLON, NT_TYPE_NAME, SEMICOLON } },
+    { NT_VAR_LIST, 3, { ID, ACT_ADD_VAR, NT_VAR_LIST_MORE } },
+    { NT_VAR_LIST_MORE, 2, { COMMA, NT_VAR_LIST } },
+    { NT_VAR_LIST_MORE, 0, { } },
+    { NT_TYPE_NAME, 2, { INT, ACT_DECLARE } },
+    { NT_TYPE_NAME, 2, { REAL, ACT_DECLARE } },
+    { NT_TYPE_NAME, 2, { BOO, ACT_DECLARE } },
+    { NT_BODY, 3, { LBRACE, NT_STMT_LIST, RBRACE } },
+    { NT_STMT_LIST, 2, { NT_STMT, NT_STMT_MORE } },
+    { NT_STMT_MORE, 2, { NT_STMT, NT_STMT_MORE } },
+    { NT_STMT_MORE, 0, { } },
+    { NT_STMT, 1, { NT_ASSIGNMENT } },
+    { NT_STMT, 1, { NT_IF } },
+    { NT_STMT, 1, { NT_WHILE } },
+    { NT_STMT, 1, { NT_SWITCH } },
+    { NT_ASSIGNMENT, 7, { ID, ACT_STATEMENT, ACT_LHS, EQUAL, ACT_EXPR, ACT_ASSIGN, SEMICOLON } },
+    { NT_IF, 9, { IF, LPAREN, ACT_STATEMENT, ACT_EXPR, ACT_IF_WHILE, ACT_OPEN_IF, RPAREN, NT_BODY, ACT_CLOSE } },
+    { NT_WHILE, 9, { WHILE, LPAREN, ACT_STATEMENT, ACT_EXPR, ACT_IF_WHILE, ACT_OPEN_WHILE, RPAREN, NT_BODY, ACT_CLOSE } },
+    { NT_SWITCH, 11, { SWITCH, LPAREN, ACT_STATEMENT, ACT_EXPR, ACT_SWITCH, ACT_OPEN_SWITCH, RPAREN, LBRACE, NT_CASE_LIST, RBRACE, ACT_CLOSE } },
+    { NT_CASE_LIST, 2, { NT_CASE, NT_CASE_MORE } },
+    { NT_CASE_MORE, 2, { NT_CASE, NT_CASE_MORE } },
+    { NT_CASE_MORE, 0, { } },
+    { NT_CASE, 6, { CASE, NUM, ACT_OPEN_CASE, COLON, NT_BODY, ACT_CLOSE } }
+};
+#define PRODUCTION_COUNT ((int) (sizeof(grammar) / sizeof(grammar[0])))
+
+//*************************************
+//END GRAMMAR
+
+//*************************************
+//START TABLE CONSTRUCTION
+
+typedef unsigned long long terminalSet;
+
+//Tokens that can start an expression, which is what ACT_EXPR consumes
+constexpr terminalSet EXPRESSION_FIRST =
+    (1ULL << ID) | (1ULL << NUM) | (1ULL << REALNUM) | (1ULL << TR) | (1ULL << FA) | (1ULL << NOT) |
+    (1ULL << PLUS) | (1ULL << MINUS) | (1ULL << MULT) | (1ULL << DIV) | (1ULL << GTEQ) | (1ULL << GREATER) |
+    (1ULL << LTEQ) | (1ULL << LESS) | (1ULL << NOTEQUAL) | (1ULL << EQUAL);
+
+struct grammarSets
+{
+    terminalSet first[NONTERMINAL_COUNT];
+    terminalSet follow[NONTERMINAL_COUNT];
+    bool nullable[NONTERMINAL_COUNT];
+};
+
+//FIRST of rhs[from..length), setting nullable when all of it can derive nothing
+constexpr terminalSet first_of_sequence(const grammarSets& sets, const production& p, int from, bool& nullable)
+{
+    terminalSet result = 0;
+    for(int i = from; i < p.length; i++)
+    {
+        int symbol = p.rhs[i];
+        if(symbol == ACT_EXPR) //Consumes a whole expression
+        {
+            nullable = false;
+            return result | EXPRESSION_FIRST;
+        }
+        else if(symbol >= FIRST_ACTION) //Other actions consume nothing
+            continue;
+        else if(symbol < FIRST_NONTERMINAL)
+        {
+            nullable = false;
+            return result | (1ULL << symbol);
+        }
+
+        result |= sets.first[symbol - FIRST_NONTERMINAL];
+        if(!sets.nullable[symbol - FIRST_NONTERMINAL])
+        {
+            nullable = false;
+            return result;
+        }
+    }
+    nullable = true;
+    return result;
+}
+
+//Computes FIRST, FOLLOW & nullable by iterating to a fixed point
+constexpr grammarSets compute_sets()
+{
+    grammarSets sets = { };
+    bool changed = true;
+
+    while(changed) //FIRST & nullable
+    {
+        changed = false;
+        for(int i = 0; i < PRODUCTION_COUNT; i++)
+        {
+            const production& p = grammar[i];
+            int lhs = p.lhs - FIRST_NONTERMINAL;
+            bool nullable = false;
+            terminalSet first = first_of_sequence(sets, p, 0, nullable);
+            if((sets.first[lhs] | first) != sets.first[lhs] || (nullable && !sets.nullable[lhs]))
+            {
+                sets.first[lhs] |= first;
+                sets.nullable[lhs] = sets.nullable[lhs] || nullable;
+                changed = true;
+            }
+        }
+    }
+
+    sets.follow[NT_PROGRAM - FIRST_NONTERMINAL] = 1ULL << END_OF_FILE;
+    changed = true;
+    while(changed) //FOLLOW
+    {
+        changed = false;
+        for(int i = 0; i < PRODUCTION_COUNT; i++)
+        {
+            const production& p = grammar[i];
+            for(int j = 0; j < p.length; j++)
+            {
+                int symbol = p.rhs[j];
+                if(symbol < FIRST_NONTERMINAL || symbol >= FIRST_ACTION)
+                    continue;
+
+                bool restNullable = false;
+                terminalSet follow = first_of_sequence(sets, p, j + 1, restNullable);
+                if(restNullable)
+                    follow |= sets.follow[p.lhs - FIRST_NONTERMINAL];
+
+                terminalSet& target = sets.follow[symbol - FIRST_NONTERMINAL];
+                if((target | follow) != target)
+                {
+                    target |= follow;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return sets;
+}
+
+constexpr grammarSets SETS = compute_sets();
+
+struct parseTable
+{
+    int entry[NONTERMINAL_COUNT][TERMINAL_COUNT];  //Production to expand, or -1
+    bool conflict;
+};
+
+//Fills the LL(1) table from FIRST & FOLLOW
+constexpr parseTable compute_table()
+{
+    parseTable table = { };
+    for(int n = 0; n < NONTERMINAL_COUNT; n++)
+        for(int t = 0; t < TERMINAL_COUNT; t++)
+            table.entry[n][t] = -1;
+
+    for(int i = 0; i < PRODUCTION_COUNT; i++)
+    {
+        const production& p = grammar[i];
+        int lhs = p.lhs - FIRST_NONTERMINAL;
+        bool nullable = false;
+        terminalSet select = first_of_sequence(SETS, p, 0, nullable);
+        if(nullable)
+            select |= SETS.follow[lhs];
+
+        for(int t = 0; t < TERMINAL_COUNT; t++)
+        {
+            if(!(select & (1ULL << t)))
+                continue;
+            if(table.entry[lhs][t] >= 0 && table.entry[lhs][t] != i)
+                table.conflict = true;
+            table.entry[lhs][t] = i;
+        }
+    }
+    return table;
+}
+
+constexpr parseTable TABLE = compute_table();
+static_assert(!TABLE.conflict, "Project3 grammar is not LL(1)");
+
+//*************************************
+//END TABLE CONSTRUCTION
+
+//*************************************
+//START ENGINE
+
+//Runs an action with the types it pushes & pops
+void run_action(int act, vector<int>& values)
+{
+    int LHS, RHS;
+    switch (act)
+    {
+        case ACT_ADD_VAR:
+            add_to_list(token.lexeme, 0);
+            break;
+        case ACT_DECLARE:
+            declare_type(token.token_type);
+            break;
+        case ACT_STATEMENT:
+            begin_statement();
+            break;
+        case ACT_LHS:
+            values.push_back(combine_variable(token.lexeme));
+            break;
+        case ACT_ASSIGN:
+            RHS = values.back();
+            values.pop_back();
+            LHS = values.back();
+            values.pop_back();
+            combine_assignment(LHS, RHS);
+            break;
+        case ACT_IF_WHILE:
+            combine_condition(values.back(), 4);
+            values.pop_back();
+            break;
+        case ACT_SWITCH:
+            combine_condition(values.back(), 5);
+            values.pop_back();
+            break;
+        case ACT_OPEN_IF:
+            open_statement(STMT_IF);
+            break;
+        case ACT_OPEN_WHILE:
+            open_statement(STMT_WHILE);
+            break;
+        case ACT_OPEN_SWITCH:
+            open_statement(STMT_SWITCH);
+            break;
+        case ACT_OPEN_CASE:
+            open_statement(STMT_CASE);
+            break;
+        case ACT_CLOSE:
+            close_statement();
+            break;
+    }
+}
+
+//Parses the program with the LL(1) table & an explicit stack of grammar symbols
+void parse_program_table()
+{
+    traceSpan span(__func__);
+    vector<int> symbols;
+    vector<int> values;
+    Token lookahead;
+    bool haveLookahead = false;
+
+    symbols.push_back(END_OF_FILE);
+    symbols.push_back(NT_PROGRAM);
+
+    while(!symbols.empty())
+    {
+        int top = symbols.back();
+        symbols.pop_back();
+
+        if(top == ACT_EXPR) //Expressions have their own stack
+        {
+            if(haveLookahead)
+                lexer.UngetToken(lookahead);
+            haveLookahead = false;
+            values.push_back(parse_expression());
+            continue;
+        }
+        else if(top >= FIRST_ACTION)
+        {
+            run_action(top, values);
+            continue;
+        }
+
+        if(!haveLookahead)
+        {
+            lookahead = lexer.GetToken();
+            haveLookahead = true;
+        }
+
+        if(top < FIRST_NONTERMINAL) //Match a terminal
+        {
+            if(lookahead.token_type != top)
+                syntax_error();
+            token = lookahead;
+            haveLookahead = false;
+            continue;
+        }
+
+        int p = -1;
+        if(lookahead.token_type < TERMINAL_COUNT)
+            p = TABLE.entry[top - FIRST_NONTERMINAL][lookahead.token_type];
+        if(p < 0) //No production for this token
+            syntax_error();
+
+        for(int i = grammar[p].length - 1; i >= 0; i--)
+            symbols.push_back(grammar[p].rhs[i]);
+    }
+}
+
+//*************************************
+//END ENGINE
@@ -0,0 +1,251 @@
+#ifndef __PARSER__H__
+#define __PARSER__H__
+
+#include <vector>
+#include <string>
+
+#include "lexer.h"
+
+//Forward Declarations
+void parse_program();
+void print_list();
+void parse_var_list();
+void parse_unary_operator();
+void update_type(int, int);
+void parse_assignment_stmt();
+void parse_case();
+void parse_case_list();
+void parse_switch_stmt();
+void parse_while_stmt();
+void parse_if_stmt();
+void parse_stmt();
+void parse_stmt_list();
+void parse_body();
+void parse_type_name();
+void declare_type(int);
+void parse_var_decl();
+void parse_var_decl_list();
+void parse_global_vars();
+void parse_program_table();
+
+bool is_binary_operator(int);
+bool is_expression(int);
+
+int parse_primary();
+int parse_expression();
+int parse_expression_recursive();
+int parse_binary_operator();
+
+int combine_variable(std::string);
+int combine_binary(int, int, int);
+int combine_not(int);
+void combine_assignment(int, int);
+void combine_condition(int, int);
+
+//Mismatch Handling
+void type_mismatch(int, int);
+void syntax_error();
+
+//For each individual variable
+struct scopeTableItem
+{
+    std::string name;
+    int line_no;
+    int type;
+    int index;
+    bool printed;
+};
+
+struct scopeTable
+{
+    scopeTableItem* item;
+    scopeTable *next;
+    scopeTable *prev;
+};
+
+//List Functions
+scopeTableItem* add_to_list(std::string, int);
+scopeTableItem* lookup_item(std::string);
+int search_table(std::string);
+
+extern scopeTable* symbolTable;
+extern LexicalAnalyzer lexer;
+extern Token token;
+extern int symbolCount;
+
+//*************************************
+//TYPE CONSTRAINTS
+
+//Kinds of constraints recorded in batch mode
+enum constraintKind
+{
+    LOAD_VAR,   //slot = type of variable lhs
+    LOAD_CONST, //slot = constant type lhs
+    BINARY_OP,  //slot = op(lhs slot, rhs slot), rule C2
+    UNARY_NOT,  //slot = lhs slot, which must be bool, rule C3
+    ASSIGN,     //lhs slot = rhs slot, rule C1
+    CONDITION,  //lhs slot is a condition, rule C4 or C5 in op
+    DECLARE     //vars below lhs declared on line_no get type op
+};
+
+//One constraint; its index doubles as the slot it defines
+struct typeConstraint
+{
+    int kind;
+    int lhs;
+    int rhs;
+    int op;
+    int line_no;
+};
+
+struct typeSolver;
+
+extern bool batchInference;
+extern bool parallelInference;
+extern int inferenceThreads;
+extern std::vector<typeConstraint> constraints;
+extern std::vector<int> statementStarts;
+
+void begin_statement();
+int emit_constraint(int, int, int, int);
+void solve_constraints();
+void solve_constraints_parallel();
+
+//Typing rules shared by the eager parser & the solver
+int check_binary(int, int, int, int&, typeSolver*);
+int check_not(int);
+int check_assignment(int, int, typeSolver*);
+int check_condition(int, int);
+
+//*************************************
+//PROGRAM TREE
+
+//Kinds of expression nodes
+enum exprKind { EXPR_VAR, EXPR_NUM, EXPR_REALNUM, EXPR_BOOL, EXPR_BINARY, EXPR_NOT };
+
+//One expression node; operands are indexes into exprNodes
+struct exprNode
+{
+    int kind;
+    int op;          //Operator token, e.g. PLUS or GREATER
+    int lhs;         //Left operand, or the operand of NOT
+    int rhs;         //Right operand
+    int var;         //Variable index for EXPR_VAR
+    long long num;   //Value for EXPR_NUM & EXPR_BOOL
+    double real;     //Value for EXPR_REALNUM
+};
+
+//Kinds of statement nodes
+enum stmtKind { STMT_ASSIGN, STMT_IF, STMT_WHILE, STMT_SWITCH, STMT_CASE };
+
+//One statement node; bodies hold indexes into stmtNodes
+struct stmtNode
+{
+    int kind;
+    int var;         //Assigned variable
+    int expr;        //Assigned value or condition
+    long long num;   //Case label
+    int line_no;
+    std::vector<int> body;
+};
+
+extern bool recordProgram;
+extern bool foldConstants;
+extern std::vector<exprNode> exprNodes;
+extern std::vector<stmtNode> stmtNodes;
+extern std::vector<int> programBody;
+
+void record_variable(int);
+void record_constant(Token);
+void record_operator(int);
+void record_binary();
+void record_not();
+void record_assignment();
+void open_statement(int);
+void close_statement();
+
+//*************************************
+//RUN TIME
+
+//Int arithmetic wraps & dividing by zero gives 0; every way of running a program uses these
+inline long long int_add(long long x, long long y) { return (long long) ((unsigned long long) x + (unsigned long long) y); }
+inline long long int_sub(long long x, long long y) { return (long long) ((unsigned long long) x - (unsigned long long) y); }
+inline long long int_mul(long long x, long long y) { return (long long) ((unsigned long long) x * (unsigned long long) y); }
+inline long long int_div(long long x, long long y)
+{
+    if(y == 0) //No trap on zero
+        return 0;
+    if(y == -1) //No trap on the smallest int
+        return int_sub(0, x);
+    return x / y;
+}
+
+int run_type(scopeTableItem*);
+int operand_type(int, int, int);
+bool arithmetic_op(int);
+void run_program();
+
+extern const char* columnInput;
+void run_columns();
+
+extern bool emitC;
+void emit_c_program();
+
+//*************************************
+//EDIT SESSIONS
+
+//Thrown instead of exiting while an edit session checks the program
+struct checkStopped {};
+
+//Top-level statements sharing lines, with their constraints; slots count from the unit's first constraint
+struct editUnit
+{
+    long long order;         //Program order, with gaps for units inserted later
+    int firstLine;
+    int lastLine;
+    int skipBefore;          //Tokens on the first line before its statements
+    int keepAfter;           //Tokens on the last line after its statements
+    std::vector<typeConstraint> constraints; //Lines count from firstLine
+    std::vector<std::pair<int, int> > vars;  //Each variable used & its first LOAD_VAR
+    bool global;             //Its last solve replaced int, real or bool
+    int mismatchCode;        //Code & constraint of its last mismatch, or 0
+    int mismatchAt;
+    int visited;
+};
+
+extern const char* editInput;
+extern bool editSession;
+extern thread_local bool quietErrors; //Errors throw checkStopped on this thread instead of printing
+extern int bodyDepth;
+extern int enumCount;
+
+void begin_top_statement();
+void end_top_statement();
+int solve_units(std::vector<editUnit*>&, const std::vector<int>&, const std::vector<int>&, std::vector<scopeTableItem*>&);
+void run_edit_session();
+
+//*************************************
+//RESULT CACHE
+
+extern const char* cachePath;
+extern bool cacheStats;
+extern int checkStatus;    //Exit status, kept with a cached result
+
+void open_result_cache(int, char*[]);
+
+//*************************************
+//TOKEN FILES
+
+extern const char* tokenOutput;
+extern const char* tokenInput;
+extern const char* tokenCheck;
+
+void open_token_files();
+int check_token_file(const char*);
+
+//*************************************
+//TOKEN PIPELINE
+
+extern bool pipelineLexer;
+
+#endif
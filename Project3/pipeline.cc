@@ -0,0 +1,131 @@
+#include <atomic>
+#include <thread>
+#include <stdlib.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+using namespace std;
+
+#define PIPELINE_SLOTS 4096 //Tokens the ring holds, a power of two
+#define PIPELINE_SPINS 64   //Looks at the other side before giving up the core
+#define PIPELINE_STOP_WAITS 4096 //Waits at exit for the lexer to stop before leaving it behind
+
+bool pipelineLexer = false;
+
+//*************************************
+//START TOKEN PIPELINE
+
+//Bounded ring from one lexing thread to the parsing thread. Each side owns one index & keeps a copy
+//of the other's, so the shared lines move between cores only when the ring looks full or empty.
+struct tokenQueue
+{
+    Token slots[PIPELINE_SLOTS];
+    alignas(64) atomic<unsigned long long> head; //Next slot the parser takes
+    unsigned long long seenTail;                 //Parser's copy of tail
+    alignas(64) atomic<unsigned long long> tail; //Next slot the lexer fills
+    unsigned long long seenHead;                 //Lexer's copy of head
+    atomic<unsigned long long> stopAt;           //Slot where the lexer stopped at a lone /, or ~0
+    alignas(64) atomic<bool> closing;            //The parser is done, so the lexer stops too
+    atomic<bool> stopped;                        //The lexer has returned
+};
+
+tokenQueue* pipelineQueue = NULL;
+thread lexingThread;
+
+//Waits a little for the other side by spinning, then by giving up the core
+static void pipeline_wait(int& spins)
+{
+    if (++spins > PIPELINE_SPINS)
+        this_thread::yield();
+}
+
+//Lexes the input into the ring until END_OF_FILE or a lone /, waiting while the ring is full; stops
+//before the next token once the parser is done
+static void lex_into(tokenQueue* q)
+{
+    LexicalAnalyzer source;
+    quietErrors = true; //A lone / stops only this thread; the parser reports it once it gets there
+    unsigned long long at = 0;
+    Token t;
+    do
+    {
+        if (q->closing.load(memory_order_relaxed))
+            break;
+        try
+        {
+            t = source.GetToken();
+        }
+        catch (checkStopped&)
+        {
+            q->stopAt.store(at, memory_order_relaxed);
+            t.lexeme = "";
+            t.token_type = END_OF_FILE;
+        }
+
+        int spins = 0;
+        while (at - q->seenHead == PIPELINE_SLOTS && (q->seenHead = q->head.load(memory_order_acquire)) + PIPELINE_SLOTS == at)
+        {
+            if (q->closing.load(memory_order_relaxed))
+                break;
+            pipeline_wait(spins);
+        }
+        if (q->closing.load(memory_order_relaxed))
+            break;
+        q->slots[at & (PIPELINE_SLOTS - 1)] = t;
+        q->tail.store(++at, memory_order_release);
+    } while (t.token_type != END_OF_FILE);
+    q->stopped.store(true, memory_order_release);
+}
+
+//Stops the lexing thread at exit, before the stats it counts are reported. A lexer that does not stop
+//within a token, e.g. one waiting on a read of input that has not ended, is left to end with the
+//process instead of joined; it only reads its own lexer & the ring, which is never freed.
+static void stop_pipeline()
+{
+    pipelineQueue->closing.store(true, memory_order_relaxed);
+    int spins = 0;
+    for (int i = 0; i < PIPELINE_STOP_WAITS && !pipelineQueue->stopped.load(memory_order_acquire); i++)
+        pipeline_wait(spins);
+    if (!lexingThread.joinable())
+        return;
+    if (pipelineQueue->stopped.load(memory_order_acquire))
+        lexingThread.join();
+    else
+        lexingThread.detach();
+}
+
+//Hands the input to a lexing thread; GetToken takes its tokens from the ring from here on
+void LexicalAnalyzer::StartPipeline()
+{
+    tokenQueue* q = new tokenQueue();
+    q->head.store(0);
+    q->tail.store(0);
+    q->seenHead = q->seenTail = 0;
+    q->stopAt.store(~0ULL);
+    q->closing.store(false);
+    q->stopped.store(false);
+    queue = pipelineQueue = q;
+    lexingThread = thread(lex_into, q);
+    atexit(stop_pipeline);
+}
+
+//Takes the next token from the ring, waiting while it is empty; the last one repeats, like the lexer at the end of its input
+Token LexicalAnalyzer::PipedToken()
+{
+    tokenQueue& q = *queue;
+    unsigned long long at = q.head.load(memory_order_relaxed);
+    int spins = 0;
+    while (at == q.seenTail && (q.seenTail = q.tail.load(memory_order_acquire)) == at)
+        pipeline_wait(spins);
+
+    if (at == q.stopAt.load(memory_order_relaxed)) //Where the lexer stopped
+        syntax_error();
+    tmp = q.slots[at & (PIPELINE_SLOTS - 1)];
+    if (tmp.token_type != END_OF_FILE)
+        q.head.store(at + 1, memory_order_release);
+    return tmp;
+}
+
+//*************************************
+//END TOKEN PIPELINE
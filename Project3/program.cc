@@ -0,0 +1,314 @@
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+using namespace std;
+
+bool recordProgram = false;
+vector<exprNode> exprNodes;
+vector<stmtNode> stmtNodes;
+vector<int> programBody;
+
+bool foldConstants = true;
+
+//Everything that makes two expression nodes identical
+struct exprKey
+{
+    int kind;
+    int op;
+    int lhs;
+    int rhs;
+    int var;
+    long long num;
+    long long realBits;
+
+    bool operator==(const exprKey& other) const
+    {
+        return kind == other.kind && op == other.op && lhs == other.lhs && rhs == other.rhs &&
+               var == other.var && num == other.num && realBits == other.realBits;
+    }
+};
+
+struct exprKeyHash
+{
+    size_t operator()(const exprKey& key) const
+    {
+        unsigned long long h = 1469598103934665603ULL; //FNV-1a over the fields
+        long long fields[] = { key.kind, key.op, key.lhs, key.rhs, key.var, key.num, key.realBits };
+        for(int i = 0; i < 7; i++)
+        {
+            h ^= (unsigned long long) fields[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+unordered_map<exprKey, int, exprKeyHash> internedExprs; //One node per distinct subtree
+vector<int> pendingExprs;    //Parsed operands waiting for their operator or statement
+vector<int> pendingOps;      //Operator tokens waiting for their operands
+vector<int> openStatements;  //Statements whose bodies are being parsed
+
+//*************************************
+//START PROGRAM RECORDING
+
+//Adds an expression node & leaves it for its operator; an identical node is shared instead
+int add_expression(exprNode node)
+{
+    exprKey key;
+    key.kind = node.kind;
+    key.op = node.op;
+    key.lhs = node.lhs;
+    key.rhs = node.rhs;
+    key.var = node.var;
+    key.num = node.num;
+    memcpy(&key.realBits, &node.real, sizeof(double)); //-0.0 & 0.0 stay apart
+
+    unordered_map<exprKey, int, exprKeyHash>::iterator found = internedExprs.find(key);
+    int expr;
+    if(found != internedExprs.end()) //Seen before
+        expr = found->second;
+    else
+    {
+        exprNodes.push_back(node);
+        expr = exprNodes.size() - 1;
+        internedExprs[key] = expr;
+    }
+    pendingExprs.push_back(expr);
+    return expr;
+}
+
+//True for NUM, REALNUM, true & false nodes
+bool is_constant(exprNode& node)
+{
+    return node.kind == EXPR_NUM || node.kind == EXPR_REALNUM || node.kind == EXPR_BOOL;
+}
+
+//Type a constant node runs as
+int constant_type(exprNode& node)
+{
+    return (node.kind == EXPR_NUM) ? 1 : (node.kind == EXPR_REALNUM) ? 2 : 3;
+}
+
+//Reads a constant as another type, converting like the VM
+long long constant_int(exprNode& node)
+{
+    return (node.kind == EXPR_REALNUM) ? (long long) node.real : node.num;
+}
+
+double constant_real(exprNode& node)
+{
+    return (node.kind == EXPR_REALNUM) ? node.real : (double) node.num;
+}
+
+bool constant_bool(exprNode& node)
+{
+    return (node.kind == EXPR_REALNUM) ? node.real != 0 : node.num != 0;
+}
+
+//Folds an operator over two constants into the constant the VM would compute
+exprNode fold_binary(int op, exprNode& x, exprNode& y)
+{
+    exprNode result = exprNode();
+    int operandType = operand_type(op, constant_type(x), constant_type(y));
+
+    if(operandType == 1)
+    {
+        long long a = constant_int(x);
+        long long b = constant_int(y);
+        result.kind = EXPR_NUM;
+        switch (op)
+        {
+            case PLUS: result.num = int_add(a, b); break;
+            case MINUS: result.num = int_sub(a, b); break;
+            case MULT: result.num = int_mul(a, b); break;
+            case DIV: result.num = int_div(a, b); break;
+            case GREATER: result.num = a > b; break;
+            case GTEQ: result.num = a >= b; break;
+            case LESS: result.num = a < b; break;
+            case LTEQ: result.num = a <= b; break;
+            case EQUAL: result.num = a == b; break;
+            default: result.num = a != b; break;
+        }
+    }
+    else if(operandType == 2)
+    {
+        double a = constant_real(x);
+        double b = constant_real(y);
+        result.kind = EXPR_REALNUM;
+        switch (op)
+        {
+            case PLUS: result.real = a + b; break;
+            case MINUS: result.real = a - b; break;
+            case MULT: result.real = a * b; break;
+            case DIV: result.real = a / b; break;
+            case GREATER: result.num = a > b; break;
+            case GTEQ: result.num = a >= b; break;
+            case LESS: result.num = a < b; break;
+            case LTEQ: result.num = a <= b; break;
+            case EQUAL: result.num = a == b; break;
+            default: result.num = a != b; break;
+        }
+    }
+    else //Bools compared with = or <>
+        result.num = (op == EQUAL) == (constant_bool(x) == constant_bool(y));
+
+    if(!arithmetic_op(op)) //Comparisons give bools
+    {
+        result.kind = EXPR_BOOL;
+        result.real = 0;
+    }
+    return result;
+}
+
+//Takes the most recent operand
+int take_expression()
+{
+    int expr = pendingExprs.back();
+    pendingExprs.pop_back();
+    return expr;
+}
+
+//Adds a statement to the body being parsed
+int add_statement(stmtNode node)
+{
+    stmtNodes.push_back(node);
+    int stmt = stmtNodes.size() - 1;
+    if(openStatements.empty()) //Top level
+        programBody.push_back(stmt);
+    else
+        stmtNodes[openStatements.back()].body.push_back(stmt);
+    return stmt;
+}
+
+//Records a variable operand
+void record_variable(int var)
+{
+    if(!recordProgram)
+        return;
+
+    exprNode node = exprNode();
+    node.kind = EXPR_VAR;
+    node.var = var;
+    add_expression(node);
+}
+
+//Records a NUM, REALNUM, true or false operand
+void record_constant(Token t)
+{
+    if(!recordProgram)
+        return;
+
+    exprNode node = exprNode();
+    if(t.token_type == NUM)
+    {
+        node.kind = EXPR_NUM;
+        node.num = strtoll(t.lexeme.str().c_str(), NULL, 10);
+    }
+    else if(t.token_type == REALNUM)
+    {
+        node.kind = EXPR_REALNUM;
+        node.real = strtod(t.lexeme.str().c_str(), NULL);
+    }
+    else //true or false
+    {
+        node.kind = EXPR_BOOL;
+        node.num = (t.token_type == TR);
+    }
+    add_expression(node);
+}
+
+//Remembers an operator token until its operands are parsed
+void record_operator(int op)
+{
+    if(!recordProgram)
+        return;
+
+    pendingOps.push_back(op);
+}
+
+//Records the latest operator over the two most recent operands
+void record_binary()
+{
+    if(!recordProgram)
+        return;
+
+    exprNode node = exprNode();
+    node.kind = EXPR_BINARY;
+    node.op = pendingOps.back();
+    pendingOps.pop_back();
+    node.rhs = take_expression();
+    node.lhs = take_expression();
+    if(foldConstants && is_constant(exprNodes[node.lhs]) && is_constant(exprNodes[node.rhs]))
+        node = fold_binary(node.op, exprNodes[node.lhs], exprNodes[node.rhs]);
+    add_expression(node);
+}
+
+//Records NOT over the most recent operand
+void record_not()
+{
+    if(!recordProgram)
+        return;
+
+    exprNode node = exprNode();
+    node.kind = EXPR_NOT;
+    node.lhs = take_expression();
+    if(foldConstants && is_constant(exprNodes[node.lhs]))
+    {
+        node.kind = EXPR_BOOL;
+        node.num = !constant_bool(exprNodes[node.lhs]);
+        node.lhs = 0;
+    }
+    add_expression(node);
+}
+
+//Records an assignment of the most recent operand to the variable before it
+void record_assignment()
+{
+    if(!recordProgram)
+        return;
+
+    stmtNode node;
+    node.kind = STMT_ASSIGN;
+    node.expr = take_expression();
+    node.var = exprNodes[take_expression()].var;
+    node.num = 0;
+    node.line_no = token.line_no;
+    add_statement(node);
+}
+
+//Starts an if, while, switch or case; the first three take the most recent operand as condition
+void open_statement(int kind)
+{
+    if(!recordProgram)
+        return;
+
+    stmtNode node;
+    node.kind = kind;
+    node.var = -1;
+    node.expr = -1;
+    node.num = 0;
+    node.line_no = token.line_no;
+    if(kind == STMT_CASE) //Label is the NUM just matched
+        node.num = strtoll(token.lexeme.str().c_str(), NULL, 10);
+    else
+        node.expr = take_expression();
+    openStatements.push_back(add_statement(node));
+}
+
+//Ends the body of the innermost open statement
+void close_statement()
+{
+    if(!recordProgram)
+        return;
+
+    openStatements.pop_back();
+}
+
+//*************************************
+//END PROGRAM RECORDING
@@ -0,0 +1,668 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+using namespace std;
+
+const char* editInput = NULL;
+bool editSession = false;
+thread_local bool quietErrors = false;
+int bodyDepth = 0;
+
+//A statement of the program body as the parser saw it
+struct topStatement
+{
+    int firstToken;       //First & last of its tokens in fedTokens
+    int lastToken;
+    int firstConstraint;  //Its constraints
+    int endConstraint;
+};
+
+vector<string> docLines;             //The program, line n at n - 1
+vector<vector<Token> > lineTokens;   //Tokens of each line; no token spans two lines
+vector<char> lineError;              //Set when the lexer stops at a lone / on the line
+
+vector<Token> fedTokens;             //Tokens handed to the parser, numbered by their real lines
+vector<int> fedStart;                //Index in fedTokens of each fed line, with one past the end
+int fedEnd;                          //One past the last token the parser gets
+vector<topStatement> topStatements;
+stringbuf restInput;                 //What the parser reads after the fed tokens
+
+vector<editUnit*> units;             //In program order
+vector<scopeTableItem*> itemOf;      //Variable index -> entry in the list
+vector<int> initialType;             //Variable index -> type after the declarations
+vector<set<pair<long long, editUnit*> > > occurrences; //Variable index -> units using it, in order
+int declaredCount;                   //Declared variables come first in the list
+vector<int> varStamp;
+int stamp = 0;
+
+bool sessionValid = false;           //Units describe the program & edits may re-check part of it
+bool hasMismatch = false;            //The last solve stopped at a mismatch
+int globalUnits = 0;                 //Units whose solve replaced int, real or bool
+
+#define ORDER_GAP (1LL << 20)
+
+//*************************************
+//START SESSION LEXING & PARSING
+
+//Lexes one line on its own
+void lex_line(const string& text, vector<Token>& tokens, char& error)
+{
+    stringbuf buffer(text + "\n");
+    streambuf* old = cin.rdbuf(&buffer);
+    cin.clear();
+    LexicalAnalyzer lineLexer;
+    tokens.clear();
+    error = false;
+
+    quietErrors = true;
+    try
+    {
+        Token t = lineLexer.GetToken();
+        while(t.token_type != END_OF_FILE)
+        {
+            tokens.push_back(t);
+            t = lineLexer.GetToken();
+        }
+    }
+    catch(checkStopped&) //A lone /, reported once the parser reaches it
+    {
+        error = true;
+    }
+    quietErrors = false;
+    cin.rdbuf(old);
+    cin.clear();
+}
+
+//Appends the tokens of a line to fedTokens, numbered with its line
+void feed_line(vector<Token>& tokens, int line_no)
+{
+    fedStart.push_back(fedTokens.size());
+    for(size_t i = 0; i < tokens.size(); i++)
+    {
+        fedTokens.push_back(tokens[i]);
+        fedTokens.back().line_no = line_no;
+    }
+}
+
+//Hands fedTokens[first, fedEnd) to the parser; a lex error after them is raised by lexing a lone /
+void feed_parser(int first, bool lexError)
+{
+    lexer = LexicalAnalyzer();
+    for(int i = fedEnd - 1; i >= first; i--)
+        lexer.UngetToken(fedTokens[i]);
+    restInput.str(lexError ? "/x" : "");
+    cin.rdbuf(&restInput);
+    cin.clear();
+}
+
+//Called by parse_stmt around each statement of the program body
+void begin_top_statement()
+{
+    topStatement s;
+    s.firstToken = fedEnd - lexer.BufferedTokens();
+    s.lastToken = s.firstToken;
+    s.firstConstraint = s.endConstraint = constraints.size();
+    topStatements.push_back(s);
+}
+
+void end_top_statement()
+{
+    topStatements.back().lastToken = fedEnd - lexer.BufferedTokens() - 1;
+    topStatements.back().endConstraint = constraints.size();
+}
+
+//True for tokens that start a statement
+bool starts_statement(int type)
+{
+    return type == ID || type == IF || type == WHILE || type == SWITCH;
+}
+
+//Groups the parsed statements into units of shared lines; fedStart counts lines from firstLine
+void build_units(int firstLine, vector<editUnit*>& built)
+{
+    varStamp.resize(symbolCount, 0);
+    for(size_t s = 0; s < topStatements.size(); )
+    {
+        editUnit* unit = new editUnit();
+        unit->firstLine = fedTokens[topStatements[s].firstToken].line_no;
+        unit->lastLine = fedTokens[topStatements[s].lastToken].line_no;
+        unit->skipBefore = topStatements[s].firstToken - fedStart[unit->firstLine - firstLine];
+
+        size_t next = s + 1;
+        while(next < topStatements.size() && fedTokens[topStatements[next].firstToken].line_no <= unit->lastLine)
+        {
+            unit->lastLine = fedTokens[topStatements[next].lastToken].line_no;
+            next++;
+        }
+        unit->keepAfter = fedStart[unit->lastLine - firstLine + 1] - 1 - topStatements[next - 1].lastToken;
+
+        //Constraints of consecutive statements are contiguous
+        int base = topStatements[s].firstConstraint;
+        int end = topStatements[next - 1].endConstraint;
+        stamp++;
+        for(int i = base; i < end; i++)
+        {
+            typeConstraint c = constraints[i];
+            if(c.kind == BINARY_OP || c.kind == ASSIGN) //Both operands are slots
+            {
+                c.lhs -= base;
+                c.rhs -= base;
+            }
+            else if(c.kind == UNARY_NOT || c.kind == CONDITION)
+                c.lhs -= base;
+            else if(c.kind == LOAD_VAR && varStamp[c.lhs] != stamp) //First use in this unit
+            {
+                varStamp[c.lhs] = stamp;
+                unit->vars.push_back(make_pair(c.lhs, i - base));
+            }
+            c.line_no -= unit->firstLine;
+            unit->constraints.push_back(c);
+        }
+        unit->global = false;
+        unit->mismatchCode = 0;
+        unit->visited = 0;
+        built.push_back(unit);
+        s = next;
+    }
+}
+
+//Adds or removes a unit from the occurrences of its variables
+void note_occurrences(editUnit* unit, bool add)
+{
+    for(size_t v = 0; v < unit->vars.size(); v++)
+    {
+        if(add)
+            occurrences[unit->vars[v].first].insert(make_pair(unit->order, unit));
+        else
+            occurrences[unit->vars[v].first].erase(make_pair(unit->order, unit));
+    }
+}
+
+//Spreads the orders of all units again
+void renumber_units()
+{
+    occurrences.assign(symbolCount, set<pair<long long, editUnit*> >());
+    for(size_t u = 0; u < units.size(); u++)
+    {
+        units[u]->order = (u + 1) * ORDER_GAP;
+        note_occurrences(units[u], true);
+    }
+}
+
+//*************************************
+//END SESSION LEXING & PARSING
+
+//*************************************
+//START SESSION CHECKING
+
+//Prints the mismatch that stopped a solve, or the list of variables
+void report(vector<editUnit*>& solved, int at)
+{
+    hasMismatch = (at >= 0);
+    if(hasMismatch)
+    {
+        editUnit* unit = solved[at];
+        try
+        {
+            type_mismatch(unit->firstLine + unit->constraints[unit->mismatchAt].line_no, unit->mismatchCode);
+        }
+        catch(checkStopped&) {}
+        return;
+    }
+
+    for(size_t v = 0; v < itemOf.size(); v++)
+        itemOf[v]->printed = false;
+    if(symbolTable != NULL)
+        print_list();
+}
+
+//Solves every unit & prints the result
+void solve_all()
+{
+    vector<int> vars(symbolCount);
+    for(int v = 0; v < symbolCount; v++)
+        vars[v] = v;
+    int at = solve_units(units, vars, initialType, itemOf);
+
+    globalUnits = 0;
+    for(size_t u = 0; u < units.size(); u++)
+        globalUnits += units[u]->global;
+    report(units, at);
+}
+
+//Throws away the list of variables & everything parsed from it
+void reset_check()
+{
+    while(symbolTable != NULL)
+    {
+        scopeTable* next = symbolTable->next;
+        delete symbolTable->item;
+        delete symbolTable;
+        symbolTable = next;
+    }
+    symbolCount = 0;
+    enumCount = 4;
+    constraints.clear();
+    statementStarts.clear();
+    topStatements.clear();
+    bodyDepth = 0;
+    for(size_t u = 0; u < units.size(); u++)
+        delete units[u];
+    units.clear();
+    sessionValid = hasMismatch = false;
+    globalUnits = 0;
+}
+
+//Checks the whole program like the batch checker & rebuilds the units
+void full_check()
+{
+    reset_check();
+    lineTokens.resize(docLines.size());
+    lineError.resize(docLines.size());
+    fedTokens.clear();
+    fedStart.clear();
+
+    bool lexError = false;
+    for(size_t n = 0; n < docLines.size(); n++)
+    {
+        lex_line(docLines[n], lineTokens[n], lineError[n]);
+        if(!lexError) //The lexer never gets past the first error
+            feed_line(lineTokens[n], n + 1);
+        lexError = lexError || lineError[n];
+    }
+    fedStart.push_back(fedTokens.size());
+    fedEnd = fedTokens.size();
+    feed_parser(0, lexError);
+
+    try
+    {
+        parse_program();
+    }
+    catch(checkStopped&) //Already reported
+    {
+        return;
+    }
+
+    itemOf.assign(symbolCount, NULL);
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+        itemOf[iterator->item->index] = iterator->item;
+
+    //Types after the declarations, as the solver's DECLARE constraints give them
+    int header = topStatements.empty() ? constraints.size() : topStatements[0].firstConstraint;
+    initialType.assign(symbolCount, 0);
+    declaredCount = 0;
+    for(int v = 0; v < symbolCount; v++)
+    {
+        initialType[v] = itemOf[v]->type;
+        declaredCount += (initialType[v] == 0);
+    }
+    vector<int> varLine(symbolCount);
+    for(int v = 0; v < symbolCount; v++)
+        varLine[v] = itemOf[v]->line_no;
+    for(int i = 0; i < header; i++) //Variables on a declaration's line are contiguous
+    {
+        vector<int>::iterator end = varLine.begin() + constraints[i].lhs;
+        vector<int>::iterator it = lower_bound(varLine.begin(), end, constraints[i].line_no);
+        for(; it != end && *it == constraints[i].line_no; it++)
+            initialType[it - varLine.begin()] = constraints[i].op;
+    }
+
+    //Edits re-check part of a program with one var section & one body only
+    bool simple = true;
+    for(int i = 0; i < header; i++)
+        simple = simple && constraints[i].kind == DECLARE;
+    for(size_t s = 1; s < topStatements.size(); s++)
+        simple = simple && topStatements[s].firstConstraint == topStatements[s - 1].endConstraint;
+    simple = simple && (topStatements.empty() || topStatements.back().endConstraint == (int) constraints.size());
+    for(int v = 0; v < declaredCount; v++)
+        simple = simple && itemOf[v]->type == 0;
+    if(!simple) //Units hold only the body's statements, so solve every constraint as the batch checker does
+    {
+        try
+        {
+            solve_constraints();
+        }
+        catch(checkStopped&) //Already reported
+        {
+            hasMismatch = true;
+            return;
+        }
+        if(symbolTable != NULL)
+            print_list();
+        return;
+    }
+
+    build_units(1, units);
+    renumber_units();
+    constraints.clear();
+    sessionValid = !units.empty();
+    solve_all();
+}
+
+//Orders implicit variables by their first use, as the list adds them
+bool first_use_before(int a, int b)
+{
+    editUnit* unitA = occurrences[a].begin()->second;
+    editUnit* unitB = occurrences[b].begin()->second;
+    if(unitA != unitB)
+        return unitA->order < unitB->order;
+
+    int posA = 0, posB = 0;
+    for(size_t v = 0; v < unitA->vars.size(); v++)
+    {
+        if(unitA->vars[v].first == a)
+            posA = unitA->vars[v].second;
+        if(unitA->vars[v].first == b)
+            posB = unitA->vars[v].second;
+    }
+    return posA < posB;
+}
+
+//Re-checks after lines a..b became newLines, re-parsing only the units around them;
+//false when the edit needs a full check
+bool incremental_check(int a, int b, vector<string>& newLines)
+{
+    int delta = newLines.size() - (b - a + 1);
+    if(a < units.front()->firstLine || b > units.back()->lastLine) //Reaches the declarations or the braces
+        return false;
+
+    //Units touching the edited lines, or the two around them
+    int u1 = 0, u2 = units.size() - 1;
+    int low = 0, high = units.size();
+    while(low < high) //First unit ending at or after a
+    {
+        int mid = (low + high) / 2;
+        if(units[mid]->lastLine < a)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    u1 = low;
+    low = 0;
+    high = units.size();
+    while(low < high) //First unit starting after b
+    {
+        int mid = (low + high) / 2;
+        if(units[mid]->firstLine <= b)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    u2 = low - 1;
+    if(u1 > u2) //Between units
+    {
+        if(u1 == 0 || u1 == (int) units.size())
+            return false;
+        u2 = u1;
+        u1--;
+    }
+    int first = min(a, units[u1]->firstLine);
+    int last = max(b, units[u2]->lastLine);
+
+    //Lines between the units, kept or removed, must have no tokens; new tokens are all parsed as statements below
+    int u = u1;
+    for(int n = first; n <= last; n++)
+    {
+        while(u <= u2 && units[u]->lastLine < n)
+            u++;
+        bool covered = (u <= u2 && units[u]->firstLine <= n);
+        if(!covered && (!lineTokens[n - 1].empty() || lineError[n - 1]))
+            return false;
+    }
+
+    //Tokens of the region, with the edited lines lexed again
+    vector<vector<Token> > editedTokens(newLines.size());
+    vector<char> editedError(newLines.size());
+    fedTokens.clear();
+    fedStart.clear();
+    for(int n = first; n < a; n++)
+        feed_line(lineTokens[n - 1], n);
+    for(size_t k = 0; k < newLines.size(); k++)
+    {
+        lex_line(newLines[k], editedTokens[k], editedError[k]);
+        if(editedError[k])
+            return false;
+        feed_line(editedTokens[k], a + k);
+    }
+    for(int n = b + 1; n <= last; n++)
+        feed_line(lineTokens[n - 1], n + delta);
+    fedStart.push_back(fedTokens.size());
+
+    //The tokens before & after the statements must not change
+    vector<Token>& firstTokens = lineTokens[units[u1]->firstLine - 1];
+    vector<Token>& lastTokens = lineTokens[units[u2]->lastLine - 1];
+    int prefix = units[u1]->skipBefore;
+    int suffix = units[u2]->keepAfter;
+    if((int) fedTokens.size() <= prefix + suffix)
+        return false;
+    for(int i = 0; i < prefix; i++)
+        if(fedTokens[i].token_type != firstTokens[i].token_type || fedTokens[i].lexeme != firstTokens[i].lexeme)
+            return false;
+    for(int i = 0; i < suffix; i++)
+    {
+        Token& now = fedTokens[fedTokens.size() - suffix + i];
+        Token& before = lastTokens[lastTokens.size() - suffix + i];
+        if(now.token_type != before.token_type || now.lexeme != before.lexeme)
+            return false;
+    }
+
+    //Parse only the statements in between
+    constraints.clear();
+    statementStarts.clear();
+    topStatements.clear();
+    int symbolsBefore = symbolCount;
+    fedEnd = fedTokens.size() - suffix;
+    feed_parser(prefix, false);
+    bool parsed = true;
+    bodyDepth = 1;
+    quietErrors = true;
+    try
+    {
+        token = lexer.GetToken();
+        while(starts_statement(token.token_type))
+        {
+            lexer.UngetToken(token);
+            parse_stmt();
+            token = lexer.GetToken();
+        }
+        parsed = (token.token_type == END_OF_FILE);
+    }
+    catch(checkStopped&)
+    {
+        parsed = false;
+    }
+    bodyDepth = 0;
+    quietErrors = false;
+    if(!parsed || topStatements.empty() || symbolCount != symbolsBefore) //A new variable moves others in the list
+        return false;
+
+    vector<editUnit*> built;
+    build_units(first, built);
+    constraints.clear();
+
+    //From here on a failed check leaves the units to a full check
+    sessionValid = false;
+    vector<int> seeds;
+    for(int k = u1; k <= u2; k++)
+    {
+        note_occurrences(units[k], false);
+        for(size_t v = 0; v < units[k]->vars.size(); v++)
+            seeds.push_back(units[k]->vars[v].first);
+        delete units[k];
+    }
+    for(size_t k = u2 + 1; k < units.size(); k++) //Moving lines is integer bookkeeping over the rest
+    {
+        units[k]->firstLine += delta;
+        units[k]->lastLine += delta;
+    }
+    long long before = (u1 > 0) ? units[u1 - 1]->order : 0;
+    long long after = (u2 + 1 < (int) units.size()) ? units[u2 + 1]->order : before + (built.size() + 1) * ORDER_GAP;
+    units.erase(units.begin() + u1, units.begin() + u2 + 1);
+    units.insert(units.begin() + u1, built.begin(), built.end());
+    if(after - before <= (long long) built.size()) //No room between the neighbours
+        renumber_units();
+    else
+    {
+        long long step = (after - before) / (built.size() + 1);
+        for(size_t k = 0; k < built.size(); k++)
+        {
+            built[k]->order = before + (k + 1) * step;
+            note_occurrences(built[k], true);
+        }
+    }
+    for(size_t k = 0; k < built.size(); k++)
+        for(size_t v = 0; v < built[k]->vars.size(); v++)
+            seeds.push_back(built[k]->vars[v].first);
+
+    lineTokens.erase(lineTokens.begin() + a - 1, lineTokens.begin() + b);
+    lineTokens.insert(lineTokens.begin() + a - 1, editedTokens.begin(), editedTokens.end());
+    lineError.erase(lineError.begin() + a - 1, lineError.begin() + b);
+    lineError.insert(lineError.begin() + a - 1, editedError.begin(), editedError.end());
+
+    //Implicit variables must stay in the list in the order of their first use
+    for(size_t s = 0; s < seeds.size(); s++)
+        if(seeds[s] >= declaredCount && occurrences[seeds[s]].empty())
+            return false;
+    for(size_t s = 0; s < seeds.size(); s++)
+    {
+        int v = seeds[s];
+        if(v < declaredCount)
+            continue;
+        if(v > declaredCount && !first_use_before(v - 1, v))
+            return false;
+        if(v + 1 < symbolCount && !first_use_before(v, v + 1))
+            return false;
+    }
+    sessionValid = true;
+
+    if(hasMismatch || globalUnits > 0) //Other units may depend on this one
+    {
+        solve_all();
+        return true;
+    }
+
+    //Otherwise only units sharing variables of unknown type with the edit can change
+    stamp++;
+    varStamp.resize(symbolCount, 0);
+    vector<editUnit*> solved(built.begin(), built.end());
+    vector<int> vars;
+    for(size_t k = 0; k < built.size(); k++)
+        built[k]->visited = stamp;
+    for(size_t s = 0; s < seeds.size(); s++)
+    {
+        if(varStamp[seeds[s]] != stamp)
+        {
+            varStamp[seeds[s]] = stamp;
+            vars.push_back(seeds[s]);
+        }
+    }
+    for(size_t next = 0; next < vars.size(); next++)
+    {
+        int v = vars[next];
+        if(initialType[v] <= 3) //Only a global replace changes a declared type
+            continue;
+        set<pair<long long, editUnit*> >::iterator it;
+        for(it = occurrences[v].begin(); it != occurrences[v].end(); it++)
+        {
+            editUnit* unit = it->second;
+            if(unit->visited == stamp)
+                continue;
+            unit->visited = stamp;
+            solved.push_back(unit);
+            for(size_t w = 0; w < unit->vars.size(); w++)
+            {
+                if(varStamp[unit->vars[w].first] != stamp)
+                {
+                    varStamp[unit->vars[w].first] = stamp;
+                    vars.push_back(unit->vars[w].first);
+                }
+            }
+        }
+    }
+    sort(solved.begin(), solved.end(), [](editUnit* x, editUnit* y) { return x->order < y->order; });
+
+    int at = solve_units(solved, vars, initialType, itemOf);
+    for(size_t k = 0; k < solved.size() && (at < 0 || (int) k <= at); k++)
+    {
+        if(solved[k]->global) //Every unit may change
+        {
+            solve_all();
+            return true;
+        }
+    }
+    report(solved, at);
+    return true;
+}
+
+//*************************************
+//END SESSION CHECKING
+
+//Reads the program from standard input & an edit script from editInput, printing the check after each edit.
+//Each edit is a line "first last" (last = first - 1 inserts), a line with a count, then that many new lines.
+void run_edit_session()
+{
+    editSession = true;
+    batchInference = true;
+    parallelInference = false;
+
+    string line;
+    while(getline(cin, line))
+        docLines.push_back(line);
+
+    ifstream edits(editInput);
+    if(!edits)
+    {
+        cerr << "Cannot open " << editInput << endl;
+        exit(1);
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    cout << "=== edit 0" << endl;
+    full_check();
+    double initialMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    int editCount = 0, incremental = 0;
+    double editMs = 0;
+    while(getline(edits, line))
+    {
+        int a, b, count;
+        if(sscanf(line.c_str(), "%d %d", &a, &b) != 2)
+            continue;
+        if(!getline(edits, line) || sscanf(line.c_str(), "%d", &count) != 1)
+            break;
+        vector<string> newLines(count);
+        for(int k = 0; k < count; k++)
+            getline(edits, newLines[k]);
+        if(a < 1 || b < a - 1 || b > (int) docLines.size())
+        {
+            cerr << "Edit " << editCount + 1 << " is outside the program" << endl;
+            exit(1);
+        }
+
+        start = chrono::steady_clock::now();
+        editCount++;
+        cout << "=== edit " << editCount << endl;
+        bool done = sessionValid && incremental_check(a, b, newLines);
+        docLines.erase(docLines.begin() + a - 1, docLines.begin() + b);
+        docLines.insert(docLines.begin() + a - 1, newLines.begin(), newLines.end());
+        if(done)
+            incremental++;
+        else
+            full_check();
+        editMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    cerr << "edits: " << editCount << ", incremental: " << incremental << ", full: " << editCount - incremental
+         << ", first check: " << initialMs << " ms, edits: " << editMs << " ms" << endl;
+}
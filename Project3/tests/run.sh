@@ -0,0 +1,32 @@
+#!/bin/bash
+#Checks each tests/*.txt in every mode against its .out, failing any run that takes over 10 s; run from Project3 after make
+#A tests/*.edits script is also run as an edit session over the .txt of the same name & checked against its .edits.out
+#A test input ending without a newline once left the lexer looping at the end of the input
+ulimit -s unlimited #The parser recurses once per statement
+
+failed=0
+for input in tests/*.txt
+do
+    for mode in "" "-batch" "-table" "-recursive" "-pipeline" "-tokens-out /tmp/tests.tok" "-tokens-in /tmp/tests.tok"
+    do
+        timeout 10 ./a.out $mode < $input > /tmp/tests.out 2>&1
+        status=$?
+        if [ $status == 124 ]
+        then
+            echo "$input ${mode:-eager}: still running after 10 s"
+            failed=1
+        elif ! cmp -s /tmp/tests.out ${input%.txt}.out
+        then
+            echo "$input ${mode:-eager}: output differs"
+            failed=1
+        fi
+    done
+    timeout 10 ./a.out -tokens-check /tmp/tests.tok < $input > /dev/null || { echo "$input -tokens-check: token file differs"; failed=1; }
+done
+for edits in tests/*.edits
+do
+    timeout 10 ./a.out -edits $edits < ${edits%.edits}.txt > /tmp/tests.out 2> /dev/null
+    cmp -s /tmp/tests.out $edits.out || { echo "$edits: output differs"; failed=1; }
+done
+[ $failed == 0 ] && echo "all tests passed"
+exit $failed
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+using namespace std;
+
+const char* tokenOutput = NULL;
+const char* tokenInput = NULL;
+const char* tokenCheck = NULL;
+
+//*************************************
+//START TOKEN FILES
+
+//Lexes the rest of the input into a token file, with each lexeme kept once in the pool
+bool LexicalAnalyzer::WriteTokens(const char* path)
+{
+    vector<tokenRecord> list;
+    string lexemes;
+    unordered_map<string, unsigned int> interned;
+    Token t;
+
+    quietErrors = true;
+    try
+    {
+        do
+        {
+            t = GetToken();
+            if(t.lexeme.size() >= (1u << 24)) //No room for the length
+            {
+                quietErrors = false;
+                return false;
+            }
+            pair<unordered_map<string, unsigned int>::iterator, bool> entry = interned.emplace(t.lexeme.str(), lexemes.size());
+            if(entry.second) //First time this lexeme is seen
+                lexemes.append(t.lexeme.data(), t.lexeme.size());
+            tokenRecord record = { (unsigned int) t.line_no, entry.first->second,
+                                   ((unsigned int) t.token_type << 24) | (unsigned int) t.lexeme.size() };
+            list.push_back(record);
+        } while(t.token_type != END_OF_FILE);
+    }
+    catch(checkStopped&) //A lone /, raised again when the parser reaches this record
+    {
+        tokenRecord record = { (unsigned int) Line(TokenOffset()), 0, (unsigned int) TOKEN_LEX_ERROR << 24 };
+        list.push_back(record);
+    }
+    quietErrors = false;
+
+    tokenFileHeader header = { TOKEN_FILE_MAGIC, TOKEN_FILE_VERSION, TOKEN_SET, (unsigned int) list.size(),
+                               (unsigned int) lexemes.size() };
+    FILE* file = fopen(path, "wb");
+    if(file == NULL)
+        return false;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(list.data(), sizeof(tokenRecord), list.size(), file) == list.size() &&
+                   fwrite(lexemes.data(), 1, lexemes.size(), file) == lexemes.size();
+    return (fclose(file) == 0) && written;
+}
+
+//Maps a token file so GetToken reads its records instead of the input; false when it is not a token file of this version
+bool LexicalAnalyzer::MapTokens(const char* path)
+{
+    int file = open(path, O_RDONLY);
+    if(file < 0)
+        return false;
+    struct stat info;
+    void* map = MAP_FAILED;
+    if(fstat(file, &info) == 0 && (size_t) info.st_size >= sizeof(tokenFileHeader))
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file); //The mapping stays until exit
+    if(map == MAP_FAILED)
+        return false;
+
+    const tokenFileHeader* header = (const tokenFileHeader*) map;
+    const tokenRecord* list = (const tokenRecord*) (header + 1);
+    bool valid = header->magic == TOKEN_FILE_MAGIC && header->version == TOKEN_FILE_VERSION &&
+                 header->tokenSet == TOKEN_SET && header->count > 0 &&
+                 sizeof(tokenFileHeader) + (unsigned long long) header->count * sizeof(tokenRecord) + header->poolSize ==
+                     (unsigned long long) info.st_size;
+    if(valid) //The last record has to stop the parser
+    {
+        unsigned int last = list[header->count - 1].typeLength >> 24;
+        valid = (last == END_OF_FILE || last == TOKEN_LEX_ERROR);
+    }
+    if(!valid)
+    {
+        munmap(map, info.st_size);
+        return false;
+    }
+
+    records = list;
+    pool = (const char*) (list + header->count);
+    recordCount = header->count;
+    poolSize = header->poolSize;
+    nextRecord = 0;
+    return true;
+}
+
+//Gets the next token from the mapped file; the last one repeats, like the lexer at the end of its input
+Token LexicalAnalyzer::ReplayToken()
+{
+    const tokenRecord& record = records[nextRecord];
+    if(nextRecord + 1 < recordCount)
+        nextRecord++;
+
+    unsigned int type = record.typeLength >> 24;
+    unsigned int length = record.typeLength & 0xffffff;
+    if(type == TOKEN_LEX_ERROR) //Where the lexer stopped
+        syntax_error();
+    if(type > ERROR || record.lexeme > poolSize || length > poolSize - record.lexeme) //Damaged file
+    {
+        cerr << "Bad record in token file" << endl;
+        exit(1);
+    }
+    tmp.lexeme.assign(pool + record.lexeme, length);
+    tmp.token_type = (TokenType) type;
+    tmp.line_no = record.line_no;
+    return tmp;
+}
+
+//*************************************
+//END TOKEN FILES
+
+//*************************************
+//START TOKEN FILE OPTIONS
+
+//Writes &/or maps the token files named by -tokens-out & -tokens-in before parsing
+void open_token_files()
+{
+    if(tokenOutput != NULL && !lexer.WriteTokens(tokenOutput))
+    {
+        cerr << "Cannot write token file " << tokenOutput << endl;
+        exit(1);
+    }
+    const char* path = (tokenOutput != NULL) ? tokenOutput : tokenInput;
+    if(path != NULL && !lexer.MapTokens(path))
+    {
+        cerr << "Not a version " << TOKEN_FILE_VERSION << " Project3 token file: " << path << endl;
+        exit(1);
+    }
+}
+
+//Gets a token, or false where the lexer or file stops at a lone /
+bool next_token(LexicalAnalyzer& source, Token& t)
+{
+    quietErrors = true;
+    try
+    {
+        t = source.GetToken();
+    }
+    catch(checkStopped&)
+    {
+        quietErrors = false;
+        return false;
+    }
+    quietErrors = false;
+    return true;
+}
+
+//Lexes the input again & compares it with a token file record by record; returns the exit status
+int check_token_file(const char* path)
+{
+    LexicalAnalyzer fileTokens;
+    if(!fileTokens.MapTokens(path))
+    {
+        cout << "Not a version " << TOKEN_FILE_VERSION << " Project3 token file: " << path << endl;
+        return 1;
+    }
+
+    LexicalAnalyzer inputTokens;
+    Token a, b;
+    for(int i = 0; ; i++)
+    {
+        bool fileGoes = next_token(fileTokens, a);
+        bool inputGoes = next_token(inputTokens, b);
+        if(fileGoes != inputGoes || (fileGoes && (a.token_type != b.token_type || a.lexeme != b.lexeme || a.line_no != b.line_no)))
+        {
+            cout << "Token " << i << " differs\n  file:  ";
+            if(fileGoes)
+                a.Print();
+            else
+                cout << "lone /\n";
+            cout << "  input: ";
+            if(inputGoes)
+                b.Print();
+            else
+                cout << "lone /\n";
+            int at = inputTokens.TokenOffset();
+            cout << "  at line " << inputTokens.Line(at) << ", column " << inputTokens.Column(at) << " of the input\n";
+            return 1;
+        }
+        if(!fileGoes || a.token_type == END_OF_FILE)
+        {
+            cout << "Token file matches the input: " << i + 1 << " tokens\n";
+            return 0;
+        }
+    }
+}
+
+//*************************************
+//END TOKEN FILE OPTIONS
@@ -0,0 +1,449 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <stdio.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+using namespace std;
+
+//*************************************
+//START BYTECODE
+
+//Every opcode once; a = destination or condition, b & c = operands or jump target
+#define OPCODES(X) \
+    X(ILOADK) X(RLOADK) X(BLOADK) \
+    X(IMOV) X(RMOV) X(BMOV) \
+    X(I2R) X(R2I) X(B2I) X(I2B) X(R2B) \
+    X(IADD) X(ISUB) X(IMUL) X(IDIV) \
+    X(RADD) X(RSUB) X(RMUL) X(RDIV) \
+    X(IGT) X(IGE) X(ILT) X(ILE) X(IEQ) X(INE) \
+    X(RGT) X(RGE) X(RLT) X(RLE) X(REQ) X(RNE) \
+    X(BEQ) X(BNE) X(BNOT) \
+    X(JMP) X(JMPF) X(JNEK) X(HALT)
+
+#define OPCODE_ENUM(name) OP_##name,
+enum opcode { OPCODES(OPCODE_ENUM) OPCODE_COUNT };
+
+struct instruction
+{
+    unsigned char op;
+    int a;
+    int b;
+    int c;
+};
+
+//Register types match the type codes; anything still unknown runs as an int
+#define INT_REG 1
+#define REAL_REG 2
+#define BOOL_REG 3
+
+struct bytecode
+{
+    vector<instruction> code;
+    vector<long long> intConsts;
+    vector<double> realConsts;
+    int registers[4];          //Size of each register file, by type
+};
+
+//Compiler state
+bytecode program;
+vector<int> varType;           //Register file of each variable, by index
+vector<int> varReg;            //Register of each variable in its file
+int tempBase[4];               //First temp of each file; raised while a switch value is live
+int tempNext[4];               //Next free temp of each file
+vector<int> cseReg;            //Register already holding each expression in this statement
+vector<int> cseType;
+vector<int> cseStatement;      //Statement that filled each entry
+int cseCurrent = 0;
+
+//*************************************
+//END BYTECODE
+
+//*************************************
+//START COMPILER
+
+//Appends an instruction & returns its position
+int emit(int op, int a, int b, int c)
+{
+    instruction inst;
+    inst.op = op;
+    inst.a = a;
+    inst.b = b;
+    inst.c = c;
+    program.code.push_back(inst);
+    return program.code.size() - 1;
+}
+
+//Claims a temp register of a type
+int new_temp(int type)
+{
+    int reg = tempNext[type]++;
+    if(tempNext[type] > program.registers[type])
+        program.registers[type] = tempNext[type];
+    return reg;
+}
+
+//Frees every temp & forgets computed expressions; statements never share them
+void reset_temps()
+{
+    for(int i = 1; i <= 3; i++)
+        tempNext[i] = tempBase[i];
+    cseCurrent++;
+}
+
+//Converts a register from one type to another, returning the new register
+int convert(int reg, int from, int to)
+{
+    if(from == to)
+        return reg;
+
+    int result = new_temp(to);
+    if(from == INT_REG && to == REAL_REG)
+        emit(OP_I2R, result, reg, 0);
+    else if(from == REAL_REG && to == INT_REG)
+        emit(OP_R2I, result, reg, 0);
+    else if(from == BOOL_REG && to == INT_REG)
+        emit(OP_B2I, result, reg, 0);
+    else if(from == INT_REG && to == BOOL_REG)
+        emit(OP_I2B, result, reg, 0);
+    else if(from == REAL_REG && to == BOOL_REG)
+        emit(OP_R2B, result, reg, 0);
+    else //Bool to real goes through int
+        emit(OP_I2R, result, convert(reg, BOOL_REG, INT_REG), 0);
+    return result;
+}
+
+//Picks the int, real or bool form of an operator
+int typed_op(int op, int type)
+{
+    int base;
+    switch (op)
+    {
+        case PLUS: base = OP_IADD; break;
+        case MINUS: base = OP_ISUB; break;
+        case MULT: base = OP_IMUL; break;
+        case DIV: base = OP_IDIV; break;
+        case GREATER: base = OP_IGT; break;
+        case GTEQ: base = OP_IGE; break;
+        case LESS: base = OP_ILT; break;
+        case LTEQ: base = OP_ILE; break;
+        case EQUAL: base = OP_IEQ; break;
+        default: base = OP_INE; break; //NOTEQUAL
+    }
+
+    if(type == BOOL_REG) //Only = & <> reach here
+        return base == OP_IEQ ? OP_BEQ : OP_BNE;
+    if(type == INT_REG)
+        return base;
+    if(base <= OP_IDIV) //Real arithmetic
+        return base - OP_IADD + OP_RADD;
+    return base - OP_IGT + OP_RGT; //Real comparison
+}
+
+int compile_node(int, int&);
+
+//Compiles an expression, returning its register & setting its type; a shared node is computed once per statement
+int compile_expression(int e, int& type)
+{
+    if(cseStatement[e] == cseCurrent)
+    {
+        type = cseType[e];
+        return cseReg[e];
+    }
+
+    int reg = compile_node(e, type);
+    cseStatement[e] = cseCurrent;
+    cseReg[e] = reg;
+    cseType[e] = type;
+    return reg;
+}
+
+//Compiles one expression node
+int compile_node(int e, int& type)
+{
+    exprNode& node = exprNodes[e];
+    int reg, LHS, RHS, lhsType, rhsType;
+
+    switch (node.kind)
+    {
+        case EXPR_VAR: //Variables are read in place
+            type = varType[node.var];
+            return varReg[node.var];
+        case EXPR_NUM:
+            type = INT_REG;
+            reg = new_temp(INT_REG);
+            emit(OP_ILOADK, reg, program.intConsts.size(), 0);
+            program.intConsts.push_back(node.num);
+            return reg;
+        case EXPR_REALNUM:
+            type = REAL_REG;
+            reg = new_temp(REAL_REG);
+            emit(OP_RLOADK, reg, program.realConsts.size(), 0);
+            program.realConsts.push_back(node.real);
+            return reg;
+        case EXPR_BOOL:
+            type = BOOL_REG;
+            reg = new_temp(BOOL_REG);
+            emit(OP_BLOADK, reg, node.num, 0);
+            return reg;
+        case EXPR_NOT:
+            LHS = compile_expression(node.lhs, lhsType);
+            LHS = convert(LHS, lhsType, BOOL_REG);
+            type = BOOL_REG;
+            reg = new_temp(BOOL_REG);
+            emit(OP_BNOT, reg, LHS, 0);
+            return reg;
+    }
+
+    LHS = compile_expression(node.lhs, lhsType);
+    RHS = compile_expression(node.rhs, rhsType);
+
+    int operandType = operand_type(node.op, lhsType, rhsType);
+    LHS = convert(LHS, lhsType, operandType);
+    RHS = convert(RHS, rhsType, operandType);
+    type = arithmetic_op(node.op) ? operandType : BOOL_REG;
+    reg = new_temp(type);
+    emit(typed_op(node.op, operandType), reg, LHS, RHS);
+    return reg;
+}
+
+//Compiles an expression into a register of the given type
+int compile_as(int e, int type)
+{
+    int exprType;
+    int reg = compile_expression(e, exprType);
+    return convert(reg, exprType, type);
+}
+
+void compile_body(vector<int>&);
+
+//Compiles one statement
+void compile_statement(int s)
+{
+    stmtNode& node = stmtNodes[s];
+    int reg, jump, top;
+    vector<int> exits;
+    reset_temps();
+
+    switch (node.kind)
+    {
+        case STMT_ASSIGN:
+            reg = compile_as(node.expr, varType[node.var]);
+            if(reg >= tempBase[varType[node.var]]) //The last instruction produced the temp
+                program.code.back().a = varReg[node.var]; //So write it straight into the variable
+            else
+                emit(OP_IMOV + varType[node.var] - INT_REG, varReg[node.var], reg, 0);
+            break;
+        case STMT_IF:
+            reg = compile_as(node.expr, BOOL_REG);
+            jump = emit(OP_JMPF, reg, 0, 0);
+            compile_body(node.body);
+            program.code[jump].b = program.code.size();
+            break;
+        case STMT_WHILE:
+            top = program.code.size();
+            reg = compile_as(node.expr, BOOL_REG);
+            jump = emit(OP_JMPF, reg, 0, 0);
+            compile_body(node.body);
+            emit(OP_JMP, 0, top, 0);
+            program.code[jump].b = program.code.size();
+            break;
+        case STMT_SWITCH:
+        {
+            int value = new_temp(INT_REG); //Evaluated once, kept away from the cases' temps
+            reg = compile_as(node.expr, INT_REG);
+            emit(OP_IMOV, value, reg, 0);
+
+            int saved = tempBase[INT_REG];
+            tempBase[INT_REG] = value + 1;
+            for(size_t i = 0; i < node.body.size(); i++) //Cases, first match wins
+            {
+                stmtNode& option = stmtNodes[node.body[i]];
+                jump = emit(OP_JNEK, value, program.intConsts.size(), 0);
+                program.intConsts.push_back(option.num);
+                compile_body(option.body);
+                exits.push_back(emit(OP_JMP, 0, 0, 0));
+                program.code[jump].c = program.code.size();
+            }
+            for(size_t i = 0; i < exits.size(); i++)
+                program.code[exits[i]].b = program.code.size();
+            tempBase[INT_REG] = saved;
+            break;
+        }
+    }
+}
+
+//Compiles a list of statements
+void compile_body(vector<int>& body)
+{
+    for(size_t i = 0; i < body.size(); i++)
+        compile_statement(body[i]);
+}
+
+//Type a variable runs as; unknown types run as ints
+int run_type(scopeTableItem* item)
+{
+    if(item->type < INT_REG || item->type > BOOL_REG)
+        return INT_REG;
+    return item->type;
+}
+
+//True for + - * /, which keep their operand type; comparisons give bools
+bool arithmetic_op(int op)
+{
+    return op == PLUS || op == MINUS || op == MULT || op == DIV;
+}
+
+//Type both operands of a binary operator run as; mixed operands widen to real, bools order as ints
+int operand_type(int op, int lhsType, int rhsType)
+{
+    if(lhsType == REAL_REG || rhsType == REAL_REG)
+        return REAL_REG;
+    if(lhsType == BOOL_REG && rhsType == BOOL_REG && (op == EQUAL || op == NOTEQUAL))
+        return BOOL_REG;
+    return INT_REG;
+}
+
+//Gives every variable a register in the file of its final type
+void assign_registers()
+{
+    varType.assign(symbolCount, INT_REG);
+    varReg.assign(symbolCount, 0);
+    for(int i = 1; i <= 3; i++)
+        program.registers[i] = 0;
+
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+    {
+        scopeTableItem* item = iterator->item;
+        int type = run_type(item);
+        varType[item->index] = type;
+        varReg[item->index] = program.registers[type]++;
+    }
+
+    for(int i = 1; i <= 3; i++)
+        tempBase[i] = tempNext[i] = program.registers[i];
+}
+
+//Compiles the recorded program
+void compile_program()
+{
+    program.code.clear();
+    program.intConsts.clear();
+    program.realConsts.clear();
+
+    cseReg.assign(exprNodes.size(), 0);
+    cseType.assign(exprNodes.size(), 0);
+    cseStatement.assign(exprNodes.size(), -1);
+    assign_registers();
+    compile_body(programBody);
+    emit(OP_HALT, 0, 0, 0);
+}
+
+//*************************************
+//END COMPILER
+
+//*************************************
+//START VM
+
+//Runs the bytecode with computed-goto dispatch; ints wrap & dividing by zero gives 0
+void execute(vector<long long>& ints, vector<double>& reals, vector<unsigned char>& bools)
+{
+    #define OPCODE_LABEL(name) &&do_##name,
+    static void* labels[] = { OPCODES(OPCODE_LABEL) };
+
+    const instruction* code = program.code.data();
+    const instruction* pc = code;
+    const long long* intConsts = program.intConsts.data();
+    const double* realConsts = program.realConsts.data();
+    long long* I = ints.data();
+    double* R = reals.data();
+    unsigned char* B = bools.data();
+
+    #define NEXT() goto *labels[(++pc)->op]
+    goto *labels[pc->op];
+
+do_ILOADK: I[pc->a] = intConsts[pc->b]; NEXT();
+do_RLOADK: R[pc->a] = realConsts[pc->b]; NEXT();
+do_BLOADK: B[pc->a] = pc->b; NEXT();
+do_IMOV: I[pc->a] = I[pc->b]; NEXT();
+do_RMOV: R[pc->a] = R[pc->b]; NEXT();
+do_BMOV: B[pc->a] = B[pc->b]; NEXT();
+do_I2R: R[pc->a] = I[pc->b]; NEXT();
+do_R2I: I[pc->a] = (long long) R[pc->b]; NEXT();
+do_B2I: I[pc->a] = B[pc->b]; NEXT();
+do_I2B: B[pc->a] = I[pc->b] != 0; NEXT();
+do_R2B: B[pc->a] = R[pc->b] != 0; NEXT();
+do_IADD: I[pc->a] = int_add(I[pc->b], I[pc->c]); NEXT();
+do_ISUB: I[pc->a] = int_sub(I[pc->b], I[pc->c]); NEXT();
+do_IMUL: I[pc->a] = int_mul(I[pc->b], I[pc->c]); NEXT();
+do_IDIV: I[pc->a] = int_div(I[pc->b], I[pc->c]); NEXT();
+do_RADD: R[pc->a] = R[pc->b] + R[pc->c]; NEXT();
+do_RSUB: R[pc->a] = R[pc->b] - R[pc->c]; NEXT();
+do_RMUL: R[pc->a] = R[pc->b] * R[pc->c]; NEXT();
+do_RDIV: R[pc->a] = R[pc->b] / R[pc->c]; NEXT();
+do_IGT: B[pc->a] = I[pc->b] > I[pc->c]; NEXT();
+do_IGE: B[pc->a] = I[pc->b] >= I[pc->c]; NEXT();
+do_ILT: B[pc->a] = I[pc->b] < I[pc->c]; NEXT();
+do_ILE: B[pc->a] = I[pc->b] <= I[pc->c]; NEXT();
+do_IEQ: B[pc->a] = I[pc->b] == I[pc->c]; NEXT();
+do_INE: B[pc->a] = I[pc->b] != I[pc->c]; NEXT();
+do_RGT: B[pc->a] = R[pc->b] > R[pc->c]; NEXT();
+do_RGE: B[pc->a] = R[pc->b] >= R[pc->c]; NEXT();
+do_RLT: B[pc->a] = R[pc->b] < R[pc->c]; NEXT();
+do_RLE: B[pc->a] = R[pc->b] <= R[pc->c]; NEXT();
+do_REQ: B[pc->a] = R[pc->b] == R[pc->c]; NEXT();
+do_RNE: B[pc->a] = R[pc->b] != R[pc->c]; NEXT();
+do_BEQ: B[pc->a] = B[pc->b] == B[pc->c]; NEXT();
+do_BNE: B[pc->a] = B[pc->b] != B[pc->c]; NEXT();
+do_BNOT: B[pc->a] = !B[pc->b]; NEXT();
+do_JMP: pc = code + pc->b; goto *labels[pc->op];
+do_JMPF:
+    if(!B[pc->a])
+    {
+        pc = code + pc->b;
+        goto *labels[pc->op];
+    }
+    NEXT();
+do_JNEK:
+    if(I[pc->a] != intConsts[pc->b])
+    {
+        pc = code + pc->c;
+        goto *labels[pc->op];
+    }
+    NEXT();
+do_HALT:
+    return;
+
+    #undef NEXT
+    #undef OPCODE_LABEL
+}
+
+//Compiles & runs the recorded program, then prints every variable
+void run_program()
+{
+    compile_program();
+
+    vector<long long> ints(program.registers[INT_REG] + 1, 0);
+    vector<double> reals(program.registers[REAL_REG] + 1, 0);
+    vector<unsigned char> bools(program.registers[BOOL_REG] + 1, 0);
+    execute(ints, reals, bools);
+
+    for(scopeTable* iterator = symbolTable; iterator != NULL; iterator = iterator->next)
+    {
+        scopeTableItem* item = iterator->item;
+        int reg = varReg[item->index];
+        cout << item->name << " = "; //Through cout, so -cache captures it with the types
+        if(varType[item->index] == REAL_REG)
+            cout << reals[reg] << "\n"; //Like %g
+        else if(varType[item->index] == BOOL_REG)
+            cout << (bools[reg] ? "true" : "false") << "\n";
+        else
+            cout << ints[reg] << "\n";
+    }
+    cout.flush();
+}
+
+//*************************************
+//END VM
@@ -0,0 +1,130 @@
+#ifndef __GEN__H__
+#define __GEN__H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// ------- program generator -------------
+//What the generators of the three projects share: a seeded random source that gives the same
+//program on every platform, output written in blocks & counted, & the knobs on the command line.
+
+//splitmix64, so one seed is one program everywhere
+struct genRandom
+{
+    unsigned long long state;
+    genRandom(unsigned long long seed) { state = seed; }
+    unsigned long long Next()
+    {
+        unsigned long long z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    long long Below(long long n) { return (long long) (Next() % (unsigned long long) n); }
+    bool Percent(int p) { return Below(100) < p; }
+};
+
+//Standard output in 64 KB blocks
+struct genOutput
+{
+    char buffer[1 << 16];
+    size_t used;
+    long long written; //Bytes so far, flushed or not
+
+    genOutput() { used = 0; written = 0; }
+    ~genOutput() { Flush(); }
+    void Put(const char* s, size_t n)
+    {
+        if (used + n > sizeof(buffer))
+            Flush();
+        if (n > sizeof(buffer))
+            fwrite(s, 1, n, stdout);
+        else
+        {
+            memcpy(buffer + used, s, n);
+            used += n;
+        }
+        written += n;
+    }
+    void Put(const char* s) { Put(s, strlen(s)); }
+    void Put(const std::string& s) { Put(s.data(), s.size()); }
+    void Number(long long n)
+    {
+        char digits[24];
+        Put(digits, snprintf(digits, sizeof(digits), "%lld", n));
+    }
+    void Name(const char* prefix, long long n) //An identifier like v12
+    {
+        Put(prefix);
+        Number(n);
+    }
+    void Flush()
+    {
+        fwrite(buffer, 1, used, stdout);
+        used = 0;
+    }
+};
+
+//A knob a generator takes: -name value
+struct genKnob
+{
+    const char* name;
+    int* value;
+    const char* help;
+};
+
+//Reads a size like 65536, 64K, 10M or 2G
+inline long long parse_size(const char* text)
+{
+    char* end;
+    long long size = strtoll(text, &end, 10);
+    if (*end == 'K' || *end == 'k')
+        size <<= 10;
+    else if (*end == 'M' || *end == 'm')
+        size <<= 20;
+    else if (*end == 'G' || *end == 'g')
+        size <<= 30;
+    return size;
+}
+
+//Reads -seed, -size, -preset & the knobs in order, so knobs after -preset change it; prints the usage & returns false on anything else
+inline bool read_knobs(int argc, char* argv[], unsigned long long& seed, long long& size, std::vector<genKnob>& knobs,
+                       const char* presets, bool (*preset)(const char*))
+{
+    for (int i = 1; i < argc; i += 2)
+    {
+        bool known = i + 1 < argc; //Every option takes a value
+        if (known && strcmp(argv[i], "-seed") == 0)
+            seed = strtoull(argv[i + 1], NULL, 10);
+        else if (known && strcmp(argv[i], "-size") == 0)
+            size = parse_size(argv[i + 1]);
+        else if (known && strcmp(argv[i], "-preset") == 0)
+            known = preset(argv[i + 1]);
+        else
+        {
+            size_t k = 0;
+            while (k < knobs.size() && (!known || strcmp(argv[i] + 1, knobs[k].name) != 0))
+                k++;
+            if (k < knobs.size())
+                *knobs[k].value = atoi(argv[i + 1]);
+            else
+                known = false;
+        }
+        if (!known)
+        {
+            fprintf(stderr, "Usage: %s [-seed n] [-size bytes[K|M|G]] [-preset %s]", argv[0], presets);
+            for (size_t k = 0; k < knobs.size(); k++)
+                fprintf(stderr, " [-%s n]", knobs[k].name);
+            fprintf(stderr, "\n");
+            for (size_t k = 0; k < knobs.size(); k++)
+                fprintf(stderr, "  -%-9s %s (%d)\n", knobs[k].name, knobs[k].help, *knobs[k].value);
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif  //__GEN__H__
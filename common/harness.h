@@ -0,0 +1,110 @@
+#ifndef __HARNESS__H__
+#define __HARNESS__H__
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "stats.h"
+
+// ------- micro benchmarks --------------
+//Runs fixed in-memory inputs through one hot path at a time & prints ns/op, bytes/s & allocations/op
+//as JSON on standard output. Allocations are counted by the operator new of stats.cc.
+
+//One hot path: setup prepares the input untimed before each run, which does ops operations over bytes of input
+struct benchCase
+{
+    std::string name;
+    long long ops;
+    long long bytes;
+    std::function<void()> setup;
+    std::function<void()> run;
+};
+
+//Repeats piece until the text is at least size bytes
+inline std::string repeat_text(const std::string& piece, size_t size)
+{
+    std::string text;
+    while (text.size() < size)
+        text += piece;
+    return text;
+}
+
+//Runs each case named in -filter warmup times, then times it reps times; options are -warmup n, -reps n & -filter text
+inline int run_benchmarks(const char* program, std::vector<benchCase>& cases, int argc, char* argv[])
+{
+    int warmup = 2;
+    int reps = 10;
+    const char* filter = "";
+    for (int i = 1; i < argc; i += 2)
+    {
+        bool valued = i + 1 < argc; //Every option takes a value
+        if (valued && strcmp(argv[i], "-warmup") == 0)
+            warmup = atoi(argv[i + 1]);
+        else if (valued && strcmp(argv[i], "-reps") == 0)
+            reps = std::max(1, atoi(argv[i + 1]));
+        else if (valued && strcmp(argv[i], "-filter") == 0)
+            filter = argv[i + 1];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [-warmup n] [-reps n] [-filter text]" << std::endl;
+            return 1;
+        }
+    }
+
+    allocTracking = true;
+    std::cout << "{\"program\":\"" << program << "\",\"warmup\":" << warmup << ",\"reps\":" << reps << ",\"benchmarks\":[";
+    bool first = true;
+    for (size_t c = 0; c < cases.size(); c++)
+    {
+        benchCase& bench = cases[c];
+        if (bench.name.find(filter) == std::string::npos)
+            continue;
+
+        for (int w = 0; w < warmup; w++)
+        {
+            bench.setup();
+            bench.run();
+        }
+
+        std::vector<double> nsPerOp;
+        long long allocations = 0;
+        for (int r = 0; r < reps; r++)
+        {
+            bench.setup();
+            long long before = allocation_count();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bench.run();
+            std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+            allocations += allocation_count() - before;
+            nsPerOp.push_back(std::chrono::duration<double, std::nano>(end - start).count() / bench.ops);
+        }
+
+        std::sort(nsPerOp.begin(), nsPerOp.end());
+        double mean = 0, deviation = 0;
+        for (size_t r = 0; r < nsPerOp.size(); r++)
+            mean += nsPerOp[r];
+        mean /= reps;
+        for (size_t r = 0; r < nsPerOp.size(); r++)
+            deviation += (nsPerOp[r] - mean) * (nsPerOp[r] - mean);
+        deviation = std::sqrt(deviation / reps);
+        double median = (reps % 2) ? nsPerOp[reps / 2] : (nsPerOp[reps / 2 - 1] + nsPerOp[reps / 2]) / 2;
+
+        std::cout << (first ? "\n" : ",\n") << "{\"name\":\"" << bench.name << "\",\"ops\":" << bench.ops
+                  << ",\"bytes\":" << bench.bytes << ",\"ns_per_op\":{\"min\":" << nsPerOp.front()
+                  << ",\"median\":" << median << ",\"mean\":" << mean << ",\"max\":" << nsPerOp.back()
+                  << ",\"stddev\":" << deviation << "},\"bytes_per_s\":" << bench.bytes / (median * bench.ops) * 1e9
+                  << ",\"allocs_per_op\":" << (double) allocations / reps / bench.ops << "}";
+        first = false;
+    }
+    std::cout << "\n]}" << std::endl;
+    return 0;
+}
+
+#endif  //__HARNESS__H__
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include "stats.h"
+
+using namespace std;
+
+bool statsEnabled = false;
+atomic<long long> statCounts[COUNTER_COUNT];
+thread_local bool timingThread = false;
+bool allocTracking = false;
+atomic<long long> allocCounts[PHASE_COUNT];
+
+const char* phaseNames[] = { "other", "input", "skip", "scan", "parse", "lookup", "unify", "output" };
+const char* counterNames[] = { "tokens_lexed", "unget_char", "unget_token", "number_backtrack",
+                               "scope_probes", "table_probes", "update_visits" };
+
+const char* statsProgram;
+long long phaseNanos[PHASE_COUNT];
+int currentPhase = PHASE_OTHER;
+chrono::steady_clock::time_point statsStart;
+chrono::steady_clock::time_point phaseMark; //When currentPhase last started or resumed
+stringbuf statsInput;
+atomic<long long> allocBytes[PHASE_COUNT];
+atomic<long long> freedBytes[PHASE_COUNT];
+atomic<long long> liveBytes;
+atomic<long long> peakLiveBytes;
+
+//*************************************
+//START STATS
+
+//Charges the time since the last switch to the current phase & switches to another
+int enter_phase(int phase)
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    phaseNanos[currentPhase] += chrono::duration_cast<chrono::nanoseconds>(now - phaseMark).count();
+    phaseMark = now;
+    int outer = currentPhase;
+    currentPhase = phase;
+    return outer;
+}
+
+//Allocations in every phase so far
+long long allocation_count()
+{
+    long long count = 0;
+    for (int p = 0; p < PHASE_COUNT; p++)
+        count += allocCounts[p].load(memory_order_relaxed);
+    return count;
+}
+
+//Prints the summary as one JSON object, however the program stops
+void report_stats()
+{
+    enter_phase(currentPhase); //Charges the phase still open
+    long long total = chrono::duration_cast<chrono::nanoseconds>(phaseMark - statsStart).count();
+
+    cerr << "{\"program\":\"" << statsProgram << "\",\"total_ns\":" << total << ",\"phases_ns\":{";
+    for (int p = 0; p < PHASE_COUNT; p++)
+        cerr << (p ? "," : "") << "\"" << phaseNames[p] << "\":" << phaseNanos[p];
+    cerr << "},\"counters\":{";
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        cerr << (c ? "," : "") << "\"" << counterNames[c] << "\":" << statCounts[c].load();
+    cerr << "}";
+    if (allocTracking)
+    {
+        allocTracking = false; //The report's own allocations are not counted
+        cerr << ",\"allocations\":{";
+        for (int p = 0; p < PHASE_COUNT; p++)
+            cerr << (p ? "," : "") << "\"" << phaseNames[p] << "\":{\"count\":" << allocCounts[p].load()
+                 << ",\"bytes\":" << allocBytes[p].load() << ",\"freed\":" << freedBytes[p].load() << "}";
+        cerr << "},\"live_bytes\":" << liveBytes.load() << ",\"peak_live_bytes\":" << peakLiveBytes.load();
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cerr << ",\"peak_rss_kb\":" << usage.ru_maxrss << "}" << endl;
+}
+
+//Turns the stats on when CSE340_STATS or CSE340_ALLOC is set to anything but 0, then reads all of standard input
+//when the program lexes it, so its time is the input phase & the lexer reads from memory
+void start_stats(const char* program, bool readInput)
+{
+    const char* setting = getenv("CSE340_STATS");
+    if (!allocTracking && (setting == NULL || *setting == '\0' || strcmp(setting, "0") == 0))
+        return;
+
+    statsEnabled = timingThread = true;
+    statsProgram = program;
+    statsStart = phaseMark = chrono::steady_clock::now();
+    atexit(report_stats);
+    if (!readInput)
+        return;
+
+    phaseTimer input(PHASE_INPUT);
+    ostringstream text;
+    text << cin.rdbuf();
+    statsInput.str(text.str());
+    cin.rdbuf(&statsInput);
+    cin.clear();
+}
+
+//*************************************
+//END STATS
+
+//*************************************
+//START ALLOCATIONS
+
+//Turns tracking on before the static objects of the program are built, so their blocks are counted when freed
+__attribute__((constructor(101))) static void start_allocations()
+{
+    const char* setting = getenv("CSE340_ALLOC");
+    allocTracking = setting != NULL && *setting != '\0' && strcmp(setting, "0") != 0;
+}
+
+//Charges a block to the phase of the main thread; other threads go to other
+static void track_allocation(size_t size)
+{
+    int phase = timingThread ? currentPhase : PHASE_OTHER;
+    allocCounts[phase].fetch_add(1, memory_order_relaxed);
+    allocBytes[phase].fetch_add(size, memory_order_relaxed);
+    long long live = liveBytes.fetch_add(size, memory_order_relaxed) + size;
+    long long peak = peakLiveBytes.load(memory_order_relaxed);
+    while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, memory_order_relaxed))
+        ;
+}
+
+static void track_free(size_t size)
+{
+    freedBytes[timingThread ? currentPhase : PHASE_OTHER].fetch_add(size, memory_order_relaxed);
+    liveBytes.fetch_sub(size, memory_order_relaxed);
+}
+
+//Every new & delete of the program comes here; untracked, each costs one test of allocTracking over malloc & free
+void* operator new(size_t size)
+{
+    void* block = malloc(size ? size : 1);
+    if (block == NULL)
+        throw bad_alloc();
+    if (allocTracking)
+        track_allocation(malloc_usable_size(block));
+    return block;
+}
+
+void operator delete(void* block) noexcept
+{
+    if (block != NULL && allocTracking)
+        track_free(malloc_usable_size(block));
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+    operator delete(block);
+}
+
+//*************************************
+//END ALLOCATIONS
@@ -0,0 +1,51 @@
+#ifndef __STATS__H__
+#define __STATS__H__
+
+#include <atomic>
+
+// ------- instrumentation ---------------
+//CSE340_STATS=1 times each phase & counts events; a JSON summary goes to stderr at exit.
+//Left unset, each timer & counter costs one test of statsEnabled.
+//CSE340_ALLOC=1 also counts what operator new & delete do in each phase, as malloc sizes the blocks.
+
+enum statPhase { PHASE_OTHER = 0, PHASE_INPUT, PHASE_SKIP, PHASE_SCAN, PHASE_PARSE,
+                 PHASE_LOOKUP, PHASE_UNIFY, PHASE_OUTPUT, PHASE_COUNT
+};
+
+enum statCounter { TOKENS_LEXED = 0, UNGET_CHARS, UNGET_TOKENS, NUMBER_BACKTRACK,
+                   SCOPE_PROBES, TABLE_PROBES, UPDATE_VISITS, COUNTER_COUNT
+};
+
+extern bool statsEnabled;
+extern std::atomic<long long> statCounts[COUNTER_COUNT];
+extern thread_local bool timingThread; //Only the main thread is timed
+extern bool allocTracking;
+extern std::atomic<long long> allocCounts[PHASE_COUNT];
+
+#define STAT_COUNT(counter) do { if (statsEnabled) statCounts[counter].fetch_add(1, std::memory_order_relaxed); } while (0)
+
+void start_stats(const char*, bool); //Checks CSE340_STATS & reads standard input as the input phase if asked
+int enter_phase(int);                //Returns the phase it interrupts
+long long allocation_count();        //Allocations in every phase so far
+
+//Times a phase while in scope, pausing the phase it interrupts
+struct phaseTimer
+{
+    int outer;
+    phaseTimer(int phase) { outer = (statsEnabled && timingThread) ? enter_phase(phase) : -1; }
+    ~phaseTimer() { if (outer >= 0) enter_phase(outer); }
+};
+
+//Counts the characters put back while in scope as backtracked
+struct backtrackCounter
+{
+    long long start;
+    backtrackCounter() { start = statsEnabled ? statCounts[UNGET_CHARS].load(std::memory_order_relaxed) : 0; }
+    ~backtrackCounter()
+    {
+        if (statsEnabled)
+            statCounts[NUMBER_BACKTRACK].fetch_add(statCounts[UNGET_CHARS].load(std::memory_order_relaxed) - start, std::memory_order_relaxed);
+    }
+};
+
+#endif  //__STATS__H__
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "trace.h"
+
+using namespace std;
+
+bool tracing = false;
+
+#define TRACE_RING (1 << 18) //Spans kept per thread
+
+//A finished span
+struct traceEvent
+{
+    const char* name;
+    long long start;
+    long long duration;
+    int depth;
+};
+
+//The spans of one thread, written only by that thread & never freed, since threads exit before the trace is written
+struct traceRing
+{
+    vector<pair<const char*, long long> > open; //Name & start of each span entered & not left
+    vector<traceEvent> events;
+    unsigned long long recorded;   //Spans ever written; the ring holds the last TRACE_RING
+    int thread;
+};
+
+const char* tracePath;
+int traceDepth = 0;                //0 keeps every depth
+int traceSample = 1;
+chrono::steady_clock::time_point traceStart;
+mutex ringsLock;                   //Taken once per thread, for its first span
+vector<traceRing*> rings;
+
+thread_local traceRing* ring = NULL;
+thread_local unsigned long long spansEnded = 0;
+
+//*************************************
+//START TRACING
+
+//Nanoseconds since the trace started
+static long long trace_clock()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceStart).count();
+}
+
+//Enters a span on this thread
+int begin_span(const char* name)
+{
+    if (ring == NULL) //First span of this thread
+    {
+        ring = new traceRing();
+        ring->recorded = 0;
+        lock_guard<mutex> lock(ringsLock);
+        ring->thread = rings.size() + 1;
+        rings.push_back(ring);
+    }
+    ring->open.push_back(make_pair(name, trace_clock()));
+    return ring->open.size();
+}
+
+//Leaves the innermost span, keeping it if it is shallow enough & sampled
+void end_span(int depth)
+{
+    long long end = trace_clock();
+    const char* name = ring->open.back().first;
+    long long start = ring->open.back().second;
+    ring->open.pop_back();
+    if ((traceDepth > 0 && depth > traceDepth) || spansEnded++ % traceSample != 0)
+        return;
+
+    traceEvent event = { name, start, end - start, depth };
+    if (ring->events.size() < TRACE_RING)
+        ring->events.push_back(event);
+    else //Full: the oldest span goes
+        ring->events[ring->recorded % TRACE_RING] = event;
+    ring->recorded++;
+}
+
+//Writes the kept spans of every thread as Chrome trace-event JSON
+void write_trace()
+{
+    while (ring != NULL && !ring->open.empty()) //Stopped by exit
+        end_span(ring->open.size());
+
+    FILE* out = fopen(tracePath, "w");
+    if (out == NULL)
+    {
+        cerr << "Cannot write trace " << tracePath << endl;
+        return;
+    }
+    lock_guard<mutex> lock(ringsLock);
+    fprintf(out, "{\"traceEvents\":[");
+    const char* separator = "\n";
+    for (size_t r = 0; r < rings.size(); r++)
+    {
+        traceRing* spans = rings[r];
+        unsigned long long first = spans->recorded - spans->events.size();
+        for (unsigned long long k = first; k < spans->recorded; k++)
+        {
+            traceEvent& event = spans->events[k % TRACE_RING];
+            fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%d}}",
+                    separator, event.name, spans->thread, event.start / 1000.0, event.duration / 1000.0, event.depth);
+            separator = ",\n";
+        }
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    fclose(out);
+}
+
+//Turns tracing on when CSE340_TRACE names a file
+void start_trace()
+{
+    const char* path = getenv("CSE340_TRACE");
+    if (path == NULL || *path == '\0')
+        return;
+
+    const char* setting = getenv("CSE340_TRACE_DEPTH");
+    if (setting != NULL && atoi(setting) > 0)
+        traceDepth = atoi(setting);
+    setting = getenv("CSE340_TRACE_SAMPLE");
+    if (setting != NULL && atoi(setting) > 0)
+        traceSample = atoi(setting);
+
+    tracing = true;
+    tracePath = path;
+    traceStart = chrono::steady_clock::now();
+    atexit(write_trace);
+}
+
+//*************************************
+//END TRACING
@@ -0,0 +1,24 @@
+#ifndef __TRACE__H__
+#define __TRACE__H__
+
+// ------- tracing -----------------------
+//CSE340_TRACE=file records parser spans & writes them to file at exit as Chrome trace-event JSON.
+//CSE340_TRACE_DEPTH=n keeps only spans at most n deep & CSE340_TRACE_SAMPLE=n keeps one span in n.
+//Each thread records into its own ring, which keeps the newest spans once full; spans still open
+//at exit end there.
+
+extern bool tracing;
+
+void start_trace();
+int begin_span(const char*);       //Returns the depth of the span
+void end_span(int);
+
+//Records the span of a function while in scope
+struct traceSpan
+{
+    int depth;
+    traceSpan(const char* name) { depth = tracing ? begin_span(name) : -1; }
+    ~traceSpan() { if (depth >= 0) end_span(depth); }
+};
+
+#endif  //__TRACE__H__
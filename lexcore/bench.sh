@@ -0,0 +1,27 @@
+#!/bin/bash
+#Times GetToken of the three projects, each a build of the shared lexer core, & its UTF-8 check; run from the top of the repository
+#Give the top of another tree, e.g. a git worktree of an older commit, to time its lexers the same way next to these
+OTHER=$1
+
+#Prints the median ns per op & MB/s of each GetToken & utf8Check case of a project's micro benchmarks
+get_tokens()
+{
+    (cd $1 && make -s bench > /tmp/lexcore_bench.json 2> /dev/null) || return
+    grep -o '{"name":"\(GetToken\|utf8Check\)[^}]*}[^}]*}[^}]*' /tmp/lexcore_bench.json |
+        sed 's/{"name":"\([^"]*\)".*"median":\([0-9.e+]*\).*"bytes_per_s":\([0-9.e+]*\).*/\1 \2 \3/' |
+        while read name median rate
+        do
+            printf "  %-24s %8.1f ns/op %8.1f MB/s\n" "$name" "$median" "$(echo "$rate" | awk '{ print $1 / 1e6 }')"
+        done
+}
+
+for project in Project1 Project2 Project3
+do
+    echo "$project"
+    get_tokens $project
+    if [ -n "$OTHER" ]
+    then
+        echo "$project in $OTHER"
+        get_tokens $OTHER/$project
+    fi
+done
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <string>
+#include <new>
+#include <cstdio>
+#include <cerrno>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "../common/stats.h"
+#include "lexcore.h"
+#include "xid.h"
+
+using namespace std;
+
+//*************************************
+//START LEXEMES
+
+#define LEXEME_CHUNK (1 << 16) //Smallest block the pool takes at a time
+
+thread_local char* poolNext = NULL; //Free space of this thread's pool
+thread_local char* poolEnd = NULL;
+
+//Makes room for size bytes in the pool, keeping the first kept bytes of old; grows old where it is when
+//they end at the free space, so text a copied token still shows is never written over
+static char* pool_place(const char* old, size_t kept, size_t size)
+{
+    if (old != NULL && old + kept == poolNext && old + size <= poolEnd)
+    {
+        poolNext = (char*) old + size;
+        return (char*) old;
+    }
+    if (poolNext == NULL || (size_t) (poolEnd - poolNext) < size) //A new block, so the old one's tail goes unused
+    {
+        size_t chunk = size * 2 > LEXEME_CHUNK ? size * 2 : LEXEME_CHUNK;
+        poolNext = (char*) malloc(chunk);
+        if (poolNext == NULL)
+            throw bad_alloc();
+        poolEnd = poolNext + chunk;
+    }
+    char* place = poolNext;
+    poolNext += size;
+    if (kept > 0)
+        memcpy(place, old, kept);
+    return place;
+}
+
+//Sets the text
+void Lexeme::assign(const char* s, size_t n)
+{
+    if (n <= LEXEME_INLINE)
+        memcpy(text, s, n);
+    else
+    {
+        char* place = pool_place(NULL, 0, n);
+        memcpy(place, s, n);
+        pooled = place;
+    }
+    count = n;
+}
+
+//Adds a character to text too long to sit inline, moving it to the pool the first time
+Lexeme& Lexeme::Append(char c)
+{
+    char* place = pool_place(data(), count, count + 1);
+    place[count] = c;
+    pooled = place;
+    count++;
+    return *this;
+}
+
+//Drops the text from an offset on, moving it back inline once it fits
+void Lexeme::erase(size_t from)
+{
+    if (from >= count)
+        return;
+    if (count > LEXEME_INLINE && from <= LEXEME_INLINE)
+    {
+        const char* place = pooled;
+        memcpy(text, place, from);
+    }
+    count = from;
+}
+
+//*************************************
+//END LEXEMES
+
+//*************************************
+//START LINE INDEX
+
+//Notes the newlines of bytes at an offset; memchr looks through them many bytes at a time
+void LineIndex::Add(const char* bytes, size_t size, int offset)
+{
+    const char* end = bytes + size;
+    for (const char* p = bytes; (p = (const char*) memchr(p, '\n', end - p)) != NULL; p++)
+        newlines.push_back(offset + (p - bytes));
+}
+
+//*************************************
+//END LINE INDEX
+
+//*************************************
+//START UTF-8
+
+//Code point of a whole sequence, -1 when overlong, a surrogate or past U+10FFFF
+int utf8_decode(const char* bytes, int length)
+{
+    static const int least[5] = { 0, 0, 0x80, 0x800, 0x10000 }; //Smallest code point each length may write
+    if (length < 2 || length > 4)
+        return -1;
+    int point = (unsigned char) bytes[0] & (0x7F >> length);
+    for (int i = 1; i < length; i++)
+        point = (point << 6) | ((unsigned char) bytes[i] & 0x3F);
+    if (point < least[length] || point > 0x10FFFF || (point >= 0xD800 && point <= 0xDFFF))
+        return -1;
+    return point;
+}
+
+//Whether a code point is in one of a table's ranges
+template <size_t N>
+static bool in_ranges(const codeRange (&ranges)[N], int point)
+{
+    const codeRange* r = upper_bound(ranges, ranges + N, point, [](int p, const codeRange& range) { return p < range.first; });
+    return r != ranges && point <= (r - 1)->last;
+}
+
+bool xid_start(int point) //Starts an ID
+{
+    return in_ranges(xidStart, point);
+}
+
+bool xid_continue(int point) //Goes on with an ID
+{
+    return in_ranges(xidContinue, point);
+}
+
+//Checks bytes at an offset, going on from the sequence the last ones left open. Outside a sequence
+//SSE2 tests 16 bytes for a high bit at once, so ASCII text is checked about as fast as it is read.
+void utf8Check::Add(const char* bytes, size_t size, int offset)
+{
+    size_t i = 0;
+    while (i < size && error < 0)
+    {
+        if (need == 0)
+        {
+#ifdef __SSE2__
+            int notAscii = 0; //A bit for each byte of the 16 at i that is not ASCII
+            while (i + 16 <= size && (notAscii = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) (bytes + i)))) == 0)
+                i += 16;
+            if (notAscii != 0)
+                i += __builtin_ctz(notAscii); //Straight to the first of them
+            else if (i == size)
+                break;
+#endif
+            unsigned char b = bytes[i];
+            if (b >= 0x80)
+            {
+                need = utf8_length(b) - 1;
+                if (need < 0) //Not a first byte
+                {
+                    need = 0;
+                    error = offset + i;
+                    break;
+                }
+                leadAt = offset + i;
+                low = (b == 0xE0) ? 0xA0 : (b == 0xF0) ? 0x90 : 0x80;  //No overlong sequences
+                high = (b == 0xED) ? 0x9F : (b == 0xF4) ? 0x8F : 0xBF; //No surrogates, nothing past U+10FFFF
+            }
+        }
+        else
+        {
+            unsigned char b = bytes[i];
+            if (b < low || b > high)
+            {
+                error = leadAt;
+                break;
+            }
+            low = 0x80;
+            high = 0xBF;
+            need--;
+        }
+        i++;
+    }
+}
+
+//*************************************
+//END UTF-8
+
+//*************************************
+//START INPUT SOURCES
+
+//Reads text from an offset on; its first line starts after the newline before the offset
+StringSource::StringSource(string_view t, size_t offset) : text(t), next(offset), indexed(offset)
+{
+    const void* newline = memrchr(text.data(), '\n', min(offset, text.size()));
+    lines.start = (newline != NULL) ? (const char*) newline - text.data() + 1 : 0;
+}
+
+//Indexes the newlines & checks the UTF-8 of a block past an offset, so lookups in order look through the text once
+void StringSource::IndexLines(size_t upTo)
+{
+    size_t end = min(text.size(), max(upTo, indexed + SOURCE_BLOCK));
+    if (end > indexed)
+    {
+        lines.Add(text.data() + indexed, end - indexed, indexed);
+        utf8.Add(text.data() + indexed, end - indexed, indexed);
+    }
+    indexed = end;
+}
+
+//Maps a whole file; an empty file needs no mapping
+MappedSource::MappedSource(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    opened = true;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void* bytes = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (bytes != MAP_FAILED)
+        {
+            madvise(bytes, info.st_size, MADV_SEQUENTIAL);
+            text = string_view((const char*) bytes, info.st_size);
+        }
+        else
+            opened = false;
+    }
+    close(fd);
+}
+
+//Reads the next block, false at the end
+bool BlockSource::Fill()
+{
+    phaseTimer reading(PHASE_INPUT);
+    consumed += filled;
+    next = filled = 0;
+    ssize_t got;
+    do
+    {
+        got = read(fd, block.data(), block.size());
+    } while (got < 0 && errno == EINTR);
+    if (got <= 0)
+        return false;
+    filled = got;
+    lines.Add(block.data(), filled, consumed);
+    utf8.Add(block.data(), filled, consumed);
+    return true;
+}
+
+//*************************************
+//END INPUT SOURCES
@@ -0,0 +1,880 @@
+#ifndef __LEXCORE__H__
+#define __LEXCORE__H__
+
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+// ------- shared lexer core -------------
+//The lexer of all three projects. A project's lexer.h describes its token set (see the end of this
+//file) & gets a LexerCore built for it, so every project is lexed by the same scanning loops with its
+//own keywords, punctuators, numbers & comments fixed at compile time. Each project's quirks are kept
+//as named styles, so no project's tokens change. common/stats.h is included before this file.
+
+// ------- lexemes ----------------------
+
+#define LEXEME_INLINE 20 //Longest text kept in the token itself
+
+//Text of a token that copies as plain bytes, so tokens move between threads & buffers without
+//allocating: up to LEXEME_INLINE bytes inline, longer text in a pool of the lexing thread that lives
+//until exit
+class Lexeme {
+  public:
+    Lexeme() { count = 0; }
+    Lexeme(const char* s) { assign(s, strlen(s)); }
+    Lexeme(const std::string& s) { assign(s.data(), s.size()); }
+
+    void assign(const char*, size_t);
+    Lexeme& operator=(const char* s) { assign(s, strlen(s)); return *this; }
+    Lexeme& operator=(const std::string& s) { assign(s.data(), s.size()); return *this; }
+    Lexeme& operator+=(char c) {
+        if (count >= LEXEME_INLINE)
+            return Append(c);
+        text[count++] = c;
+        return *this;
+    }
+    void erase(size_t); //Drops the text from an offset on
+
+    const char* data() const { return count <= LEXEME_INLINE ? text : pooled; }
+    size_t size() const { return count; }
+    size_t length() const { return count; }
+    bool empty() const { return count == 0; }
+    char operator[](size_t i) const { return data()[i]; }
+    std::string str() const { return std::string(data(), count); }
+    operator std::string() const { return str(); }
+
+    bool operator==(const Lexeme& other) const { return count == other.count && memcmp(data(), other.data(), count) == 0; }
+    bool operator!=(const Lexeme& other) const { return !(*this == other); }
+    bool operator==(const std::string& s) const { return count == s.size() && memcmp(data(), s.data(), count) == 0; }
+    bool operator==(std::string_view s) const { return count == s.size() && memcmp(data(), s.data(), count) == 0; }
+    bool operator==(const char* s) const { return count == strlen(s) && memcmp(data(), s, count) == 0; }
+
+  private:
+    unsigned int count;
+    union {
+        char text[LEXEME_INLINE];
+        const char* pooled;
+    };
+
+    Lexeme& Append(char); //Adds a character to text in the pool
+};
+
+inline std::ostream& operator<<(std::ostream& out, const Lexeme& lexeme) {
+    return out.write(lexeme.data(), lexeme.size());
+}
+
+// ------- line index --------------------
+
+//Offsets of the newlines of a source, so the line & column of a byte are found when they are wanted
+//instead of counted a character at a time while skipping. Lookups in order, as tokens come, step a
+//cursor one newline on; others are binary searches.
+struct LineIndex {
+    int start = 0;     //Offset the first line starts at
+    int firstLine = 1;
+    std::vector<int> newlines;
+
+    void Add(const char*, size_t, int); //Notes the newlines of bytes at an offset
+    int Line(int offset) { Seek(offset); return firstLine + cursor; }
+    int Column(int offset) { Seek(offset); return offset - (cursor > 0 ? newlines[cursor - 1] + 1 : start) + 1; }
+
+  private:
+    size_t cursor = 0; //Newlines before the offset last looked up
+
+    void Seek(int offset) {
+        if (cursor > 0 && newlines[cursor - 1] >= offset)
+            cursor = std::lower_bound(newlines.begin(), newlines.begin() + cursor, offset) - newlines.begin();
+        else if (cursor < newlines.size() && newlines[cursor] < offset && ++cursor < newlines.size() && newlines[cursor] < offset)
+            cursor = std::lower_bound(newlines.begin() + cursor, newlines.end(), offset) - newlines.begin();
+    }
+};
+
+// ------- UTF-8 -------------------------
+//An ID may hold letters past ASCII written in UTF-8: XID_Start ones first, XID_Continue ones after. A
+//byte of 0x80 or more only leads to these tests where an ASCII letter or digit would have ended the
+//ID, so ASCII text costs nothing more. A byte that starts no such letter is an ERROR, as it always was.
+
+inline bool is_high(char c) { return (unsigned char) c >= 0x80; }             //Not ASCII
+inline bool utf8_continues(char c) { return ((unsigned char) c & 0xC0) == 0x80; } //A byte after the first of a sequence
+inline int utf8_length(char c) {                                              //Bytes of the sequence c starts, 0 when it starts none
+    unsigned char b = c;
+    return (b < 0x80) ? 1 : (b < 0xC2) ? 0 : (b < 0xE0) ? 2 : (b < 0xF0) ? 3 : (b < 0xF5) ? 4 : 0;
+}
+int utf8_decode(const char*, int); //Code point of a whole sequence, -1 when overlong, a surrogate or past U+10FFFF
+bool xid_start(int);               //Starts an ID
+bool xid_continue(int);            //Goes on with an ID
+
+//Checks UTF-8 a block at a time, as a source gets its bytes, skipping 16 ASCII bytes at a time with SSE2
+struct utf8Check {
+    void Add(const char*, size_t, int); //Checks bytes at an offset, going on from the sequence the last ones left open
+    int Error() { return (error < 0 && need > 0) ? leadAt : error; } //Where the first bad sequence starts, -1 when there is none
+
+  private:
+    int error = -1;
+    int need = 0;      //Bytes still to come of the open sequence
+    int leadAt = 0;    //Offset of its first byte
+    unsigned char low = 0x80, high = 0xBF; //Range of its next byte
+};
+
+// ------- input sources -----------------
+//Where an InputBuffer reads from. A source has Get, which reads the next character & returns false
+//past the end leaving c alone, Offset, the bytes read so far, Lines, its LineIndex up to an offset
+//read already, & Utf8Error, where its bytes stop being UTF-8. The lexer is built for each source, so
+//the character reads of the scanning loops are inlined.
+
+//Standard input through cin, a character at a time; cin keeps no text, so newlines are noted as read
+struct StreamSource {
+    int count = 0;
+    LineIndex lines;
+
+    bool Get(char& c) {
+        if (!std::cin.get(c))
+            return false;
+        if (c == '\n')
+            lines.newlines.push_back(count);
+        count++;
+        return true;
+    }
+    int Offset() { return count; }
+    LineIndex& Lines(int) { return lines; }
+    int Utf8Error() { return -1; } //Not checked
+};
+
+//Text in memory, from an offset on; its newlines are looked for & its UTF-8 checked a block at a time as lines are wanted
+struct StringSource {
+    std::string_view text;
+    size_t next = 0;
+    LineIndex lines;
+    utf8Check utf8;
+    size_t indexed = 0; //Bytes looked through for newlines & checked as UTF-8
+
+    StringSource() {}
+    StringSource(std::string_view, size_t offset = 0);
+
+    bool Get(char& c) {
+        if (next >= text.size())
+            return false;
+        c = text[next++];
+        return true;
+    }
+    int Offset() { return next; }
+    LineIndex& Lines(int upTo) {
+        if ((size_t) upTo > indexed)
+            IndexLines(upTo);
+        return lines;
+    }
+    int Utf8Error() { IndexLines(text.size()); return utf8.Error(); }
+
+  private:
+    void IndexLines(size_t); //Indexes at least up to an offset
+};
+
+//A file mapped into memory & read like a string; the mapping lives until exit
+struct MappedSource : StringSource {
+    bool opened = false; //False when the file cannot be opened, so there is nothing to read
+
+    MappedSource() {}
+    MappedSource(const char*);
+};
+
+#define SOURCE_BLOCK (1 << 16) //Bytes a BlockSource reads at once
+
+//A file descriptor read a block at a time, indexing the newlines & checking the UTF-8 of each block as it comes
+struct BlockSource {
+    int fd = -1;
+    std::vector<char> block;
+    size_t next = 0;
+    size_t filled = 0;
+    int consumed = 0; //Bytes of the blocks before this one
+    LineIndex lines;
+    utf8Check utf8;
+
+    BlockSource() {}
+    BlockSource(int descriptor) : fd(descriptor), block(SOURCE_BLOCK) {}
+
+    bool Get(char& c) {
+        if (next == filled && !Fill())
+            return false;
+        c = block[next++];
+        return true;
+    }
+    int Offset() { return consumed + next; }
+    LineIndex& Lines(int) { return lines; }
+    int Utf8Error() { return utf8.Error(); } //Of the blocks read so far
+
+  private:
+    bool Fill(); //Reads the next block, false at the end
+};
+
+// ------- input buffer ------------------
+
+//Characters of a source with the ones put back in front of them
+template <class Source>
+class InputBuffer {
+  public:
+    InputBuffer() { reach = source.Offset() - 1; at_end = false; }
+    InputBuffer(const Source& s) : source(s) { reach = source.Offset() - 1; at_end = false; }
+
+    void GetChar(char& c) {
+        if (!input_buffer.empty()) {
+            c = input_buffer.back();
+            input_buffer.pop_back();
+        } else if (source.Get(c)) { //Like cin.get, c is left alone at the end
+            reach = std::max(reach, source.Offset() - 1);
+        } else {
+            at_end = true;
+            reach = source.Offset();
+        }
+    }
+    bool ReadAhead(char& c) { //Like GetChar, but past the end it only returns false, so the input has not ended yet
+        if (!input_buffer.empty()) {
+            c = input_buffer.back();
+            input_buffer.pop_back();
+            return true;
+        }
+        if (source.Get(c)) {
+            reach = std::max(reach, source.Offset() - 1);
+            return true;
+        }
+        reach = source.Offset();
+        return false;
+    }
+    char UngetChar(char c) {
+        if (c != EOF)
+        {
+            input_buffer.push_back(c);
+            STAT_COUNT(UNGET_CHARS);
+        }
+        return c;
+    }
+    bool EndOfInput() { return input_buffer.empty() && at_end; }
+
+    int Position() { return source.Offset() - input_buffer.size(); } //Offset of the next character; characters put back were the ones just read
+    int Read() { return source.Offset(); }                            //Bytes read from the source
+    int NewlinesPutBack() { return std::count(input_buffer.begin(), input_buffer.end(), '\n'); } //Newlines read & put back
+    int Reach() { return reach; }                                     //Furthest offset read since ResetReach, the length once past the end
+    void ResetReach() { reach = source.Offset() - 1; }
+    LineIndex& Lines(int upTo) { return source.Lines(upTo); }         //Newlines of the source, indexed up to an offset
+    int Utf8Error() { return source.Utf8Error(); }
+    const std::vector<char>& PutBack() { return input_buffer; }       //Characters put back, the next one last; a put back
+                                                                      //0xFF is dropped as EOF, so they need not match the source
+    void SetPutBack(const std::vector<char>& c) { input_buffer = c; } //Puts back characters as another buffer held them, uncounted
+
+  private:
+    std::vector<char> input_buffer;
+    Source source;
+    int reach;
+    bool at_end;
+};
+
+// ------- character classes -------------
+
+enum charClass { CHAR_SPACE = 1, CHAR_DIGIT = 2, CHAR_UPPER = 4, CHAR_LOWER = 8 };
+
+//Classes of each byte as the C locale has them, so no test goes through the locale
+struct charClasses {
+    unsigned char of[256];
+
+    constexpr charClasses() : of() {
+        for (int c = 0; c < 256; c++)
+            of[c] = ((c == ' ' || (c >= '\t' && c <= '\r')) ? CHAR_SPACE : 0) | ((c >= '0' && c <= '9') ? CHAR_DIGIT : 0) |
+                    ((c >= 'A' && c <= 'Z') ? CHAR_UPPER : 0) | ((c >= 'a' && c <= 'z') ? CHAR_LOWER : 0);
+    }
+};
+
+inline constexpr charClasses charTable;
+
+inline bool is_space(char c) { return charTable.of[(unsigned char) c] & CHAR_SPACE; }
+inline bool is_digit(char c) { return charTable.of[(unsigned char) c] & CHAR_DIGIT; }
+inline bool is_alpha(char c) { return charTable.of[(unsigned char) c] & (CHAR_UPPER | CHAR_LOWER); }
+inline bool is_alnum(char c) { return charTable.of[(unsigned char) c] & (CHAR_DIGIT | CHAR_UPPER | CHAR_LOWER); }
+inline bool is_digit8(char c) { return c >= '0' && c <= '7'; }                                            //A digit of a BASE08NUM
+inline bool is_digit16(char c) { return is_digit(c) || (c >= 'A' && c <= 'F'); } //A digit of a BASE16NUM
+
+// ------- token sets --------------------
+//A project describes its tokens with a struct holding:
+//  token, type                 its Token class & TokenType enum
+//  endOfFile, error, id        the types of those tokens
+//  keywords[]                  keyword i is type i + 1
+//  punctuators[]               each punctuator & the pairs it starts
+//  numbers & num, realNum, base08Num, base16Num
+//  comments & loneSlash        what // does, & the type of a / that starts no comment
+//  pairUngetsAtEnd             whether the character after the first of a pair is put back even past the end
+//  keywordPrefixes             whether keywords match on their letters as soon as the first is read
+//  BadComment()                called on a / that starts no comment, only needed with STRICT_COMMENTS
+
+enum numberStyle {
+    NO_NUMBERS,   //A digit is an ERROR
+    REAL_NUMBERS, //NUM & REALNUM; a . not followed by a digit is dropped, as Project3 always did
+    BASED_NUMBERS //NUM, REALNUM, BASE08NUM & BASE16NUM, putting back a failed base, as Project1 does
+};
+
+enum commentStyle {
+    NO_COMMENTS,
+    LINE_COMMENTS,  //// to the end of the line is skipped where a token starts, the line counted twice
+    STRICT_COMMENTS //// to the end of the line is skipped between spaces; any other / is BadComment
+};
+
+//A punctuator alone, or followed by second or third
+template <class Type>
+struct punctuator {
+    char first;
+    Type alone;
+    char second = '\0';
+    Type withSecond = Type();
+    char third = '\0';
+    Type withThird = Type();
+};
+
+enum scanAction { SCAN_OTHER = 0, SCAN_SINGLE, SCAN_PAIR, SCAN_COMMENT, SCAN_PREFIX };
+
+//What GetToken does with each first character, built from a token set at compile time
+template <class TokenSet>
+struct scanTable {
+    unsigned char action[256];
+    unsigned char index[256]; //Punctuator of SCAN_SINGLE & SCAN_PAIR
+
+    constexpr scanTable() : action(), index() {
+        for (size_t i = 0; i < std::size(TokenSet::punctuators); i++)
+        {
+            unsigned char c = TokenSet::punctuators[i].first;
+            action[c] = (TokenSet::punctuators[i].second != '\0') ? SCAN_PAIR : SCAN_SINGLE;
+            index[c] = i;
+        }
+        if (TokenSet::comments == LINE_COMMENTS)
+            action[(unsigned char) '/'] = SCAN_COMMENT;
+        if (TokenSet::keywordPrefixes)
+        {
+            for (size_t k = 0; k < std::size(TokenSet::keywords); k++)
+                action[(unsigned char) TokenSet::keywords[k][0]] = SCAN_PREFIX;
+        }
+    }
+};
+
+// ------- lexer core --------------------
+
+//Lexes the characters of a Source with the tokens of a TokenSet
+template <class TokenSet, class Source = StreamSource>
+class LexerCore {
+  public:
+    typedef typename TokenSet::token token;
+    typedef typename TokenSet::type type;
+
+    LexerCore();
+    LexerCore(const Source&, int); //Lexes a source from the line it starts on
+
+    token GetToken() {
+        if (!tokens.empty()) {
+            tmp = tokens.back();
+            tokens.pop_back();
+            return tmp;
+        }
+        phaseTimer scan(PHASE_SCAN);
+        return Scan();
+    }
+    type UngetToken(token tok) {
+        STAT_COUNT(UNGET_TOKENS);
+        tokens.push_back(tok);
+        return tok.token_type;
+    }
+
+    int TokenOffset() { return token_offset; }  //Where the last token read starts
+    int Offset() { return input.Position(); }   //Where lexing goes on from
+    int Reach() { return input.Reach(); }       //Furthest offset looked at for the last token
+    int Line(int offset) { return input.Lines(offset).Line(offset); }     //Line of a byte read already
+    int Column(int offset) { return input.Lines(offset).Column(offset); } //Column, from 1, of a byte read already
+    int Utf8Error() { return input.Utf8Error(); } //Where the input stops being UTF-8, -1 when it does not or the source is unchecked
+
+  protected:
+    std::vector<token> tokens;
+    int token_offset;
+    bool newlineAtEnd; //A newline ends the input; the END_OF_FILE line counts it twice, as the lexers always have
+    token tmp;
+    InputBuffer<Source> input;
+
+    static constexpr scanTable<TokenSet> table = scanTable<TokenSet>();
+
+    token Scan() { //Lexes the next token from the input, counted once
+        STAT_COUNT(TOKENS_LEXED);
+        return ScanToken();
+    }
+    token ScanToken(); //Scan without counting, where a comment begins again
+    bool SkipSpace();
+    void SkipComments();
+    token SkipComment();
+    bool IsKeyword(const Lexeme&);
+    type FindKeywordIndex(const Lexeme&);
+    bool ScanKeywordPrefix(char);
+    token ScanIdOrKeyword();
+    bool ScanUnicodeLetter(char, bool);
+    token ScanNumber();
+    void BacktrackNumber();
+
+    friend struct benchAccess; //The micro benchmarks time the scanners on their own
+};
+
+template <class TokenSet, class Source>
+LexerCore<TokenSet, Source>::LexerCore() //Constructor
+{
+    this->token_offset = 0;
+    this->newlineAtEnd = false;
+    tmp.lexeme = "";
+    tmp.line_no = 1;
+    tmp.token_type = TokenSet::error;
+}
+
+template <class TokenSet, class Source>
+LexerCore<TokenSet, Source>::LexerCore(const Source& source, int line) //Constructor for a source starting on a line
+    : input(source)
+{
+    input.Lines(0).firstLine = line;
+    this->token_offset = input.Position();
+    this->newlineAtEnd = false;
+    tmp.lexeme = "";
+    tmp.line_no = line;
+    tmp.token_type = TokenSet::error;
+}
+
+template <class TokenSet, class Source>
+bool LexerCore<TokenSet, Source>::SkipSpace() //Assists with skipping spaces
+{
+    char c = EOF; //Stays EOF when nothing is left to read
+    bool space_encountered = false;
+
+    input.GetChar(c);
+
+    while (!input.EndOfInput() && is_space(c))
+    {
+        space_encountered = true;
+        input.GetChar(c);
+    }
+
+    if (!input.EndOfInput())
+        input.UngetChar(c);
+    else if (c == '\n') //c is left as the last character read
+        newlineAtEnd = true;
+    return space_encountered;
+}
+
+template <class TokenSet, class Source>
+void LexerCore<TokenSet, Source>::SkipComments() //Skips // comments between spaces, for STRICT_COMMENTS
+{
+    char c = EOF; //Stays EOF when nothing is left to read
+
+    if constexpr (TokenSet::comments == STRICT_COMMENTS)
+    {
+        if (input.EndOfInput()) //Check for EOF
+            return;
+        input.GetChar(c);
+        if (c == '/') //Check for first /
+        {
+            token_offset = input.Position() - 1; //Where a lone / is reported
+            input.GetChar(c);
+            if (!input.EndOfInput() && c == '/') //Check for second /; past the end c is still the first
+            {
+                while (!input.EndOfInput() && c != '\n') //Go through comment, which may end the input
+                    input.GetChar(c);
+                SkipComments(); //Repeat
+            }
+            else //Else an error
+                TokenSet::BadComment();
+        }
+        else //Else not a comment
+            input.UngetChar(c);
+    }
+}
+
+template <class TokenSet, class Source>
+typename TokenSet::token LexerCore<TokenSet, Source>::SkipComment() //Skips the rest of a // line & lexes the token after it, for LINE_COMMENTS
+{
+    {
+        phaseTimer skip(PHASE_SKIP);
+        char c = EOF; //Stays EOF when nothing is left to read
+        input.GetChar(c);
+
+        while (!input.EndOfInput() && c != '\n') //Skip to end of line
+            input.GetChar(c);
+
+        if (!input.EndOfInput())
+            input.UngetChar(c);
+    }
+    return ScanToken(); //Begin again
+}
+
+template <class TokenSet, class Source>
+bool LexerCore<TokenSet, Source>::IsKeyword(const Lexeme& s)
+{
+    for (size_t i = 0; i < std::size(TokenSet::keywords); i++)
+    {
+        if (s == TokenSet::keywords[i])
+            return true;
+    }
+    return false;
+}
+
+template <class TokenSet, class Source>
+typename TokenSet::type LexerCore<TokenSet, Source>::FindKeywordIndex(const Lexeme& s)
+{
+    for (size_t i = 0; i < std::size(TokenSet::keywords); i++)
+    {
+        if (s == TokenSet::keywords[i])
+            return (type) (i + 1);
+    }
+    return TokenSet::error;
+}
+
+//Reads the letters after the first of each keyword starting with it, so a keyword is found without
+//looking at what follows; puts them back, as '\0' past the end, when none matches
+template <class TokenSet, class Source>
+bool LexerCore<TokenSet, Source>::ScanKeywordPrefix(char c)
+{
+    char rest[64] = { 0 };
+    size_t read = 0;
+    for (size_t k = 0; k < std::size(TokenSet::keywords); k++)
+    {
+        std::string_view keyword = TokenSet::keywords[k];
+        if (keyword[0] != c)
+            continue;
+        while (read < keyword.size() - 1)
+            input.GetChar(rest[read++]);
+        if (memcmp(rest, keyword.data() + 1, keyword.size() - 1) == 0)
+        {
+            tmp.token_type = (type) (k + 1);
+            return true;
+        }
+    }
+    while (read > 0)
+        input.UngetChar(rest[--read]);
+    return false;
+}
+
+//Reads the rest of the UTF-8 sequence c starts & adds it whole to the lexeme when it is a letter that can start
+//an ID, or go on with one; otherwise puts back the bytes after c. Reading ahead never ends the input, so c is
+//still an ERROR of its own when the input ends inside its sequence
+template <class TokenSet, class Source>
+bool LexerCore<TokenSet, Source>::ScanUnicodeLetter(char c, bool first)
+{
+    char sequence[4] = { c };
+    int length = utf8_length(c);
+    int read = 1;
+    char b;
+    while (read < length && input.ReadAhead(b))
+    {
+        if (!utf8_continues(b))
+        {
+            input.UngetChar(b);
+            break;
+        }
+        sequence[read++] = b;
+    }
+
+    int point = (read == length) ? utf8_decode(sequence, length) : -1;
+    if (point < 0 || !(first ? xid_start(point) : xid_continue(point)))
+    {
+        while (read > 1)
+            input.UngetChar(sequence[--read]);
+        return false;
+    }
+    for (int i = 0; i < length; i++)
+        tmp.lexeme += sequence[i];
+    return true;
+}
+
+template <class TokenSet, class Source>
+typename TokenSet::token LexerCore<TokenSet, Source>::ScanIdOrKeyword() //Handles ID format
+{
+    char c = EOF; //Stays EOF when nothing is left to read
+    input.GetChar(c);
+    tmp.lexeme = "";
+
+    bool letter = is_alpha(c) || (is_high(c) && ScanUnicodeLetter(c, true)); //A letter past ASCII is in the lexeme already
+    if (letter)
+    {
+        bool ended = input.EndOfInput();
+        while (!ended && letter)
+        {
+            if (!is_high(c))
+                tmp.lexeme += c;
+            input.GetChar(c);
+            ended = input.EndOfInput();
+            letter = is_alnum(c) || (!ended && is_high(c) && ScanUnicodeLetter(c, false));
+        }
+        if (!ended)
+            input.UngetChar(c);
+        if (IsKeyword(tmp.lexeme))
+            tmp.token_type = FindKeywordIndex(tmp.lexeme);
+        else
+            tmp.token_type = TokenSet::id;
+    }
+    else
+    {
+        if (!input.EndOfInput() && !is_high(c)) //A byte past ASCII starting no letter is the ERROR itself
+            input.UngetChar(c);
+        tmp.token_type = TokenSet::error;
+    }
+    return tmp;
+}
+
+template <class TokenSet, class Source>
+void LexerCore<TokenSet, Source>::BacktrackNumber() //Puts back everything after the leading decimal digits, leaving a NUM
+{
+    int front = 0;
+    while (front < (int) tmp.lexeme.length() && is_digit(tmp.lexeme[front]))
+        front++;
+    for (int back = tmp.lexeme.length() - 1; back >= front; back--)
+    {
+        input.UngetChar(tmp.lexeme[back]);
+        tmp.lexeme.erase(back);
+    }
+    tmp.token_type = TokenSet::num;
+}
+
+template <class TokenSet, class Source>
+typename TokenSet::token LexerCore<TokenSet, Source>::ScanNumber() //Checks for type of number
+{
+    backtrackCounter backtracked;
+    char c = EOF; //Stays EOF when nothing is left to read
+
+    if constexpr (TokenSet::numbers == REAL_NUMBERS)
+    {
+        bool isREALNUM = false;
+
+        input.GetChar(c);
+        if (c == '0') //Check for only REALNUM
+        {
+            tmp.lexeme = "0";
+            input.GetChar(c);
+            if (c == '.') //Check for DOT
+            {
+                input.GetChar(c);
+                if (is_digit(c)) //Is REALNUM
+                {
+                    tmp.lexeme += '.'; //Keep the DOT so -run sees the value
+                    while (!input.EndOfInput() && is_digit(c)) //Get REALNUM
+                    {
+                        tmp.lexeme += c;
+                        isREALNUM = true;
+                        input.GetChar(c);
+                    }
+                    input.UngetChar(c);
+                }
+                else //Else not REALNUM
+                    input.UngetChar(c);
+            }
+            else //Else not a REALNUM
+                input.UngetChar(c);
+        }
+        else //Check for NUM & REALNUM
+        {
+            tmp.lexeme = "";
+            while (!input.EndOfInput() && is_digit(c)) //Get NUM
+            {
+                tmp.lexeme += c;
+                input.GetChar(c);
+            }
+
+            if (c == '.') //Check for DOT
+            {
+                input.GetChar(c);
+                if (is_digit(c)) //Is REALNUM
+                {
+                    tmp.lexeme += '.'; //Keep the DOT so -run sees the value
+                    while (!input.EndOfInput() && is_digit(c)) //Get REALNUM
+                    {
+                        tmp.lexeme += c;
+                        isREALNUM = true;
+                        input.GetChar(c);
+                    }
+                }
+                else //Else not REALNUM
+                    input.UngetChar(c);
+            }
+
+            if (!input.EndOfInput()) //Check for EOF
+                input.UngetChar(c);
+        }
+
+        tmp.token_type = isREALNUM ? TokenSet::realNum : TokenSet::num;
+        return tmp;
+    }
+    else
+    {
+        char b = '\0', a = '\0'; //What b & a hold when the number ends the input
+        bool base8 = true;
+        bool base10 = true;
+        input.GetChar(c);
+        input.GetChar(b);
+
+        if (!is_digit(c)) //Error Condition
+        {
+            input.UngetChar(b);
+            if (!input.EndOfInput())
+                input.UngetChar(c);
+            tmp.lexeme = "";
+            tmp.token_type = TokenSet::error;
+                return tmp;
+        }
+        if (c == '0' && b != 'x' && b != '.') //Base check for NUM
+        {
+            input.UngetChar(b);
+            tmp.lexeme = "0";
+            tmp.token_type = TokenSet::num;
+                return tmp;
+        }
+
+        input.UngetChar(b);
+        tmp.lexeme = "";
+        while (!input.EndOfInput() && is_digit8(c)) //Checks for digit
+        {
+            tmp.lexeme += c;
+            input.GetChar(c);
+        }
+        while (!input.EndOfInput() && is_digit(c)) //Checks for base8 conditions
+        {
+            base8 = false;
+            tmp.lexeme += c;
+            input.GetChar(c);
+        }
+        while (!input.EndOfInput() && is_digit16(c)) //Checks for base16 conditions
+        {
+            base8 = false;
+            base10 = false;
+            tmp.lexeme += c;
+            input.GetChar(c);
+        }
+
+        if (c == 'x') //Check for BASE08NUM, BASE16NUM & Edge conditions
+        {
+            input.GetChar(b);
+            input.GetChar(a);
+            if ((b == '0' && a == '8' && base8) || (b == '1' && a == '6'))
+            {
+                tmp.lexeme += c;
+                tmp.lexeme += b;
+                tmp.lexeme += a;
+                tmp.token_type = (b == '0') ? TokenSet::base08Num : TokenSet::base16Num;
+                    }
+            else //Return NUM and backtrack
+            {
+                input.UngetChar(a);
+                input.UngetChar(b);
+                input.UngetChar(c);
+                BacktrackNumber();
+            }
+        }
+        else if (c == '.' && base10) //Check for REALNUM
+        {
+            input.GetChar(b);
+            if (!is_digit(b)) //Check for NUM
+            {
+                input.UngetChar(b);
+                input.UngetChar(c);
+                tmp.token_type = TokenSet::num;
+                        return tmp;
+            }
+
+            tmp.lexeme += c;
+            tmp.lexeme += b;
+            input.GetChar(c);
+
+            while (is_digit(c) && !input.EndOfInput()) //Collect the REALNUM
+            {
+                tmp.lexeme += c;
+                input.GetChar(c);
+            }
+            if (!input.EndOfInput()) //Backtrack end of file
+                input.UngetChar(c);
+            tmp.token_type = TokenSet::realNum;
+            }
+        else if (c != '.' && base10) //Check for NUM
+        {
+            input.UngetChar(c);
+            tmp.token_type = TokenSet::num;
+            }
+        else //Return NUM and backtrack
+        {
+            input.UngetChar(c);
+            BacktrackNumber();
+        }
+        return tmp;
+    }
+}
+
+template <class TokenSet, class Source>
+typename TokenSet::token LexerCore<TokenSet, Source>::ScanToken()
+{
+    char c = EOF; //Stays EOF when nothing is left to read
+
+    input.ResetReach();
+    {
+        phaseTimer skip(PHASE_SKIP);
+        SkipSpace();
+        if constexpr (TokenSet::comments == STRICT_COMMENTS)
+        {
+            SkipComments();
+            SkipSpace(); //Skip spacing after comments
+        }
+    }
+    token_offset = input.Position();
+    tmp.lexeme = "";
+    tmp.line_no = Line(input.Read()) - input.NewlinesPutBack() + newlineAtEnd; //Past the end, '\0's put back were never read
+    input.GetChar(c);
+
+    unsigned char at = c;
+    switch (table.action[at]) {
+        case SCAN_SINGLE:
+            tmp.token_type = TokenSet::punctuators[table.index[at]].alone;
+            return tmp;
+        case SCAN_PAIR: {
+            const punctuator<type>& p = TokenSet::punctuators[table.index[at]];
+            input.GetChar(c);
+            if (c == p.second)
+                tmp.token_type = p.withSecond;
+            else if (p.third != '\0' && c == p.third)
+                tmp.token_type = p.withThird;
+            else
+            {
+                if (TokenSet::pairUngetsAtEnd || !input.EndOfInput())
+                    input.UngetChar(c);
+                tmp.token_type = p.alone;
+            }
+            return tmp;
+        }
+        case SCAN_COMMENT: {
+            char b = '\0'; //Put back as '\0' past the end of the input
+            input.GetChar(b);
+            if (b == '/')
+                return SkipComment();
+            input.UngetChar(b);
+            tmp.token_type = TokenSet::loneSlash;
+            return tmp;
+        }
+        case SCAN_PREFIX:
+            if (ScanKeywordPrefix(c))
+                return tmp;
+            [[fallthrough]];
+        default:
+            if (TokenSet::numbers != NO_NUMBERS && is_digit(c)) //Check for Number types
+            {
+                input.UngetChar(c);
+                return ScanNumber();
+            }
+            else if (is_alpha(c) || (is_high(c) && c != EOF && !input.EndOfInput())) //Check for ID, which may start with a letter past ASCII
+            {
+                input.UngetChar(c);
+                return ScanIdOrKeyword();
+            }
+            else if (input.EndOfInput()) //Check for EOF
+                tmp.token_type = TokenSet::endOfFile;
+            else //Else there is an error
+                tmp.token_type = TokenSet::error;
+            return tmp;
+    }
+}
+
+#endif  //__LEXCORE__H__
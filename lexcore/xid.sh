@@ -0,0 +1,39 @@
+#!/bin/bash
+#Writes xid.h, the code points past ASCII that can start & go on with a UTF-8 identifier, from the Unicode
+#data of python3: str.isidentifier tests XID_Start for the first character & XID_Continue for the rest
+cd "$(dirname "$0")"
+python3 - > xid.h <<'PYTHON'
+import unicodedata
+
+def ranges(test):
+    found, first = [], None
+    for point in range(0x80, 0x110001):
+        inside = point <= 0x10FFFF and test(chr(point))
+        if inside and first is None:
+            first = point
+        elif not inside and first is not None:
+            found.append((first, point - 1))
+            first = None
+    return found
+
+def table(name, found):
+    print("static constexpr codeRange %s[] = {" % name)
+    for i in range(0, len(found), 6):
+        print("    " + " ".join("{ 0x%04X, 0x%04X }," % r for r in found[i:i + 6]))
+    print("};")
+
+print("//Generated by xid.sh from Unicode %s; do not edit" % unicodedata.unidata_version)
+print("//Ranges of the code points past ASCII that are XID_Start & XID_Continue, for UTF-8 identifiers")
+print("#ifndef __XID__H__")
+print("#define __XID__H__")
+print("")
+print("struct codeRange {")
+print("    int first, last;")
+print("};")
+print("")
+table("xidStart", ranges(lambda c: c.isidentifier()))
+print("")
+table("xidContinue", ranges(lambda c: ("a" + c).isidentifier()))
+print("")
+print("#endif  //__XID__H__")
+PYTHON